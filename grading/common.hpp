@@ -170,12 +170,24 @@ public:
     static auto get_resolution() noexcept {
         return convert(::clock_getres);
     }
+    /** Get the current time of the clock used.
+     * @return Current time (in ns, from an arbitrary origin), 'invalid_tick' on failure
+    **/
+    static auto get_time() noexcept {
+        return convert(::clock_gettime);
+    }
 public:
     /** Start measuring a time segment.
     **/
     void start() noexcept {
         local = convert(::clock_gettime);
     }
+    /** Start measuring a time segment from a given time.
+     * @param tick Start of the segment, as given by 'get_time'
+    **/
+    void start(Tick tick) noexcept {
+        local = tick;
+    }
     /** Measure a time segment.
     **/
     auto delta() noexcept {
@@ -199,6 +211,105 @@ public:
     }
 };
 
+/** Log-linear latency histogram class, with a bounded relative error and a constant footprint.
+ * Recording is not thread-safe: each thread records in its own histograms, merged once the threads are done.
+**/
+class alignas(64) Histogram final {
+public:
+    constexpr static auto sub_bits = 4u; // Log2 of the number of linear sub-buckets per power of 2 (i.e. at most 1/16 relative error)
+private:
+    constexpr static auto sub_count = size_t{1} << sub_bits;
+    constexpr static auto nbbuckets = (64 - sub_bits + 1) * sub_count;
+    uint_fast64_t buckets[nbbuckets]; // Number of samples per bucket
+    uint_fast64_t count; // Total number of samples
+    Chrono::Tick  max;   // Largest sample
+private:
+    /** Get the bucket of a sample.
+     * @param tick Sample
+     * @return Bucket index
+    **/
+    constexpr static size_t index(Chrono::Tick tick) noexcept {
+        if (tick < sub_count)
+            return tick;
+        auto exp = 63u - static_cast<unsigned int>(__builtin_clzll(tick));
+        return (exp - sub_bits + 1) * sub_count + ((tick >> (exp - sub_bits)) & (sub_count - 1));
+    }
+    /** Get the largest sample of a bucket.
+     * @param index Bucket index
+     * @return Largest sample in the bucket
+    **/
+    constexpr static Chrono::Tick upper(size_t index) noexcept {
+        if (index < sub_count)
+            return index;
+        auto exp = index / sub_count + sub_bits - 1;
+        auto lower = static_cast<Chrono::Tick>(sub_count + index % sub_count) << (exp - sub_bits);
+        return lower + (Chrono::Tick{1} << (exp - sub_bits)) - 1;
+    }
+public:
+    /** Empty histogram constructor.
+    **/
+    Histogram() noexcept {
+        reset();
+    }
+public:
+    /** Record a sample.
+     * @param tick Sample (in ns)
+    **/
+    void record(Chrono::Tick tick) noexcept {
+        ++buckets[index(tick)];
+        ++count;
+        if (tick > max)
+            max = tick;
+    }
+    /** Add the samples of another histogram.
+     * @param other Histogram to merge
+    **/
+    void merge(Histogram const& other) noexcept {
+        for (size_t i = 0; i < nbbuckets; ++i)
+            buckets[i] += other.buckets[i];
+        count += other.count;
+        if (other.max > max)
+            max = other.max;
+    }
+    /** Remove every sample.
+    **/
+    void reset() noexcept {
+        for (auto& bucket: buckets)
+            bucket = 0;
+        count = 0;
+        max   = 0;
+    }
+public:
+    /** Get the number of samples.
+     * @return Number of samples
+    **/
+    auto get_count() const noexcept {
+        return count;
+    }
+    /** Get the largest sample.
+     * @return Largest sample, 0 if none
+    **/
+    auto get_max() const noexcept {
+        return max;
+    }
+    /** Get an upper bound on the given quantile of the samples.
+     * @param quantile Quantile to get (between 0 and 1)
+     * @return Upper bound on the quantile, 0 if no sample
+    **/
+    Chrono::Tick get_quantile(double quantile) const noexcept {
+        auto rank = static_cast<uint_fast64_t>(quantile * static_cast<double>(count) + 0.999999); // Rank of the sample, rounded up
+        if (rank == 0)
+            rank = 1;
+        uint_fast64_t seen = 0;
+        for (size_t i = 0; i < nbbuckets; ++i) {
+            seen += buckets[i];
+            if (seen >= rank)
+                return upper(i) < max ? upper(i) : max;
+        }
+        return max;
+    }
+};
+
 /** Atomic waitable latch class.
 **/
 class Latch final {
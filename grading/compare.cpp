@@ -0,0 +1,261 @@
+/**
+ * @file   compare.cpp
+ * @author Sébastien Rouault <sebastien.rouault@epfl.ch>
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Comparison of two grading results (written with '--format=csv'), flagging the statistically significant slowdowns.
+**/
+
+// External headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Results, Any, "unable to read grading results");
+
+}
+// -------------------------------------------------------------------------- //
+
+/** Grading results: value of each (library index, key), the parameters having an empty library index.
+**/
+using Results = ::std::map<::std::tuple<::std::string, ::std::string>, ::std::string>;
+
+/** Split a CSV line into its fields.
+ * @param line Line to split
+ * @return Unquoted fields
+**/
+static auto split(::std::string const& line) {
+    ::std::vector<::std::string> res(1);
+    auto quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        auto c = line[i];
+        if (quoted) {
+            if (c != '"') {
+                res.back() += c;
+            } else if (i + 1 < line.size() && line[i + 1] == '"') { // Escaped quote
+                res.back() += c;
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            res.emplace_back();
+        } else if (c != '\r') {
+            res.back() += c;
+        }
+    }
+    return res;
+}
+
+/** Load grading results.
+ * @param path Path of the CSV file
+ * @return Loaded results
+**/
+static auto load(char const* path) {
+    ::std::ifstream file{path};
+    if (!file)
+        throw Exception::Results{"unable to open a results file"};
+    ::std::string line;
+    if (!::std::getline(file, line) || split(line) != ::std::vector<::std::string>{"library", "key", "value"})
+        throw Exception::Results{"results file not written with '--format=csv'"};
+    Results res;
+    while (::std::getline(file, line)) {
+        auto fields = split(line);
+        if (fields.size() != 3)
+            throw Exception::Results{"malformed results file"};
+        res[::std::make_tuple(fields[0], fields[1])] = fields[2];
+    }
+    return res;
+}
+
+/** Parse a list of space-separated numbers.
+ * @param value List to parse
+ * @return Parsed numbers
+**/
+static auto numbers(::std::string const& value) {
+    ::std::vector<double> res;
+    ::std::istringstream in{value};
+    for (double x; in >> x;)
+        res.push_back(x);
+    return res;
+}
+
+/** Check whether a key ends with the given suffix.
+ * @param key    Key to check
+ * @param suffix Null-terminated suffix
+ * @return Whether the key ends with the suffix
+**/
+static bool ends_with(::std::string const& key, char const* suffix) {
+    auto size = ::std::strlen(suffix);
+    return key.size() >= size && key.compare(key.size() - size, size, suffix) == 0;
+}
+
+/** Get the median of a non-empty sample.
+ * @param sample Sample (copied, as partially reordered)
+ * @return Median
+**/
+static double median(::std::vector<double> sample) {
+    auto mid = sample.size() / 2;
+    ::std::nth_element(sample.begin(), sample.begin() + mid, sample.end());
+    auto res = sample[mid];
+    if (sample.size() % 2 == 0)
+        res = (res + *::std::max_element(sample.begin(), sample.begin() + mid)) / 2.;
+    return res;
+}
+
+/** One-sided Mann-Whitney U test (normal approximation, with tie and continuity corrections).
+ * It does not assume normally distributed times, and is robust to the occasional outlier repetition.
+ * @param base Baseline sample (non-empty)
+ * @param cand Candidate sample (non-empty)
+ * @return p-value of the hypothesis "the candidate values are not larger than the baseline values"
+**/
+static double mann_whitney(::std::vector<double> const& base, ::std::vector<double> const& cand) {
+    ::std::vector<::std::tuple<double, bool>> all; // Value, whether from the candidate
+    for (auto x: base)
+        all.emplace_back(x, false);
+    for (auto x: cand)
+        all.emplace_back(x, true);
+    ::std::sort(all.begin(), all.end());
+    auto const n1 = static_cast<double>(base.size());
+    auto const n2 = static_cast<double>(cand.size());
+    auto const n  = n1 + n2;
+    double ranks = 0.; // Sum of the ranks of the candidate values
+    double ties  = 0.; // Sum of t^3 - t over the groups of t tied values
+    for (size_t i = 0; i < all.size();) {
+        auto j = i + 1;
+        while (j < all.size() && ::std::get<0>(all[j]) == ::std::get<0>(all[i]))
+            ++j;
+        auto rank = static_cast<double>(i + j + 1) / 2.; // Average of the (1-based) ranks i+1..j
+        for (auto k = i; k < j; ++k) {
+            if (::std::get<1>(all[k]))
+                ranks += rank;
+        }
+        auto t = static_cast<double>(j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+    auto u  = ranks - n2 * (n2 + 1.) / 2.;
+    auto sd = ::std::sqrt(n1 * n2 / 12. * ((n + 1.) - ties / (n * (n - 1.))));
+    if (sd <= 0.) // All values tied
+        return 1.;
+    auto z = (u - n1 * n2 / 2. - 0.5) / sd;
+    return 0.5 * ::std::erfc(z / ::std::sqrt(2.));
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Program entry point.
+ * @param argc Arguments count
+ * @param argv Arguments values
+ * @return Program return code (0 if no significant slowdown, 1 if any, 2 on error)
+**/
+int main(int argc, char** argv) {
+    try {
+        // Parse command line option(s)
+        auto const progname = argc > 0 ? argv[0] : "compare";
+        auto alpha     = 0.01; // Significance level of the test
+        auto threshold = 0.02; // Relative change of the median below which a difference is not reported
+        while (argc > 1 && ::std::strncmp(argv[1], "--", 2) == 0) {
+            if (::std::strncmp(argv[1], "--alpha=", 8) == 0) {
+                alpha = ::std::stod(argv[1] + 8);
+            } else if (::std::strncmp(argv[1], "--threshold=", 12) == 0) {
+                threshold = ::std::stod(argv[1] + 12);
+            } else {
+                ::std::cout << "Unknown option '" << argv[1] << "'" << ::std::endl;
+                return 2;
+            }
+            --argc;
+            ++argv;
+        }
+        if (argc != 3) {
+            ::std::cout << "Usage: " << progname << " [--alpha=<significance level>] [--threshold=<relative change>] <baseline results> <candidate results>" << ::std::endl;
+            return 2;
+        }
+        auto base = load(argv[1]);
+        auto cand = load(argv[2]);
+        // Differing parameters make the timings hardly comparable
+        ::std::cout << "⎧ Baseline:  " << argv[1] << ::std::endl;
+        ::std::cout << "⎪ Candidate: " << argv[2] << ::std::endl;
+        for (auto&& [id, value]: base) {
+            if (!::std::get<0>(id).empty() || ::std::get<1>(id) == "clock_resolution_ns")
+                continue;
+            auto other = cand.find(id);
+            if (other != cand.end() && other->second != value)
+                ::std::cout << "⎪ Warning: parameter '" << ::std::get<1>(id) << "' differs (" << value << " -> " << other->second << ")" << ::std::endl;
+        }
+        // Time-bounded repetitions all last about the deadline: only their throughputs tell a slowdown
+        auto duration = base.find(::std::make_tuple(::std::string{}, ::std::string{"duration_s"}));
+        auto const bounded = duration != base.end() && !duration->second.empty() && duration->second != "null";
+        auto const samples = bounded ? "throughputs" : "times_ns";
+        ::std::cout << "⎩ Significance level " << alpha << ", relative threshold " << threshold << ", comparing " << (bounded ? "repetition throughputs (time-bounded)" : "repetition times") << ::std::endl;
+        // Compare every sample of repetition times, or of repetition throughputs
+        auto nbslower = 0ul;
+        for (auto&& [id, value]: base) {
+            auto const& library = ::std::get<0>(id);
+            auto const& key     = ::std::get<1>(id);
+            if (library.empty() || !ends_with(key, samples))
+                continue;
+            auto other = cand.find(id);
+            if (other == cand.end())
+                continue;
+            auto base_values = numbers(value);
+            auto cand_values = numbers(other->second);
+            if (base_values.empty() || cand_values.empty())
+                continue;
+            auto base_median = median(base_values);
+            auto cand_median = median(cand_values);
+            auto change = bounded ? base_median / cand_median - 1. : cand_median / base_median - 1.; // Relative increase of the time per unit of work
+            auto p_slower = bounded ? mann_whitney(cand_values, base_values) : mann_whitney(base_values, cand_values);
+            auto p_faster = bounded ? mann_whitney(base_values, cand_values) : mann_whitney(cand_values, base_values);
+            char const* verdict = "unchanged";
+            if (p_slower < alpha && change > threshold) {
+                verdict = "SLOWDOWN";
+                ++nbslower;
+            } else if (p_faster < alpha && -change > threshold) {
+                verdict = "speedup";
+            }
+            auto path = base.find(::std::make_tuple(library, ::std::string{"path"}));
+            ::std::cout << "⎧ Library #" << library << " '" << (path != base.end() ? path->second : "?") << "', " << key << ::std::endl;
+            if (bounded)
+                ::std::cout << "⎪ Median: " << base_median << " TX/s -> " << cand_median << " TX/s (" << (change >= 0. ? "+" : "") << (100. * change) << "% time per TX)" << ::std::endl;
+            else
+                ::std::cout << "⎪ Median: " << (base_median / 1000000.) << " ms -> " << (cand_median / 1000000.) << " ms (" << (change >= 0. ? "+" : "") << (100. * change) << "%)" << ::std::endl;
+            ::std::cout << "⎩ " << verdict << " (p = " << (change >= 0. ? p_slower : p_faster) << ", " << base_values.size() << " vs " << cand_values.size() << " repetitions)" << ::std::endl;
+        }
+        return nbslower > 0 ? 1 : 0;
+    } catch (::std::exception const& err) {
+        ::std::cerr << "⎧ *** EXCEPTION ***" << ::std::endl;
+        ::std::cerr << "⎩ " << err.what() << ::std::endl;
+        return 2;
+    }
+}
@@ -25,12 +25,28 @@
 #include <algorithm>
 #include <atomic>
 #include <cstring>
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <memory>
+#include <optional>
 #include <random>
+#include <sstream>
+#include <string>
 #include <variant>
+extern "C" {
+#include <stdlib.h>
+#include <unistd.h>
+}
 
 // Internal headers
 #include "common.hpp"
+#include "perf.hpp"
+#include "report.hpp"
+#include "topology.hpp"
 #include "transactional.hpp"
 #include "workload.hpp"
 
@@ -70,7 +86,8 @@ public:
     /** Master trigger "synchronized" execution in all threads (instead of joining).
     **/
     void master_notify() noexcept {
-        status.store(Status::Wait, ::std::memory_order_relaxed);
+        status.store(Status::Wait, ::std::memory_order_release); // Synchronize-with workers waiting for the run, so that they see what the master prepared
+        runtime.reset(); // Each run is timed on its own
         runtime.start();
     }
     /** Master trigger termination in all threads (instead of notifying).
@@ -101,7 +118,7 @@ public:
     **/
     bool worker_wait() noexcept {
         while (true) {
-            auto res = status.load(::std::memory_order_relaxed);
+            auto res = status.load(::std::memory_order_acquire); // Synchronize-with the master notifying the run
             if (res == Status::Wait)
                 break;
             if (res == Status::Quit)
@@ -138,6 +155,32 @@ public:
     }
 };
 
+/** First-touch the shared memory of a workload from the given CPUs, by running its initialization there.
+ * @param workload Workload instance to initialize
+ * @param cpus     CPUs to run the initialization on
+ * @return Error constant null-terminated string ('nullptr' for none)
+**/
+static char const* first_touch(Workload& workload, ::std::vector<Topology::Cpu> const& cpus) {
+    auto placed = false;
+    char const* error = nullptr;
+    ::std::exception_ptr exception; // Rethrown in the calling worker, whose handler reports it
+    ::std::thread toucher{[&]() {
+        try {
+            placed = Topology::pin(cpus);
+            if (placed)
+                error = workload.init();
+        } catch (...) {
+            exception = ::std::current_exception();
+        }
+    }};
+    toucher.join();
+    if (unlikely(exception))
+        ::std::rethrow_exception(exception);
+    if (unlikely(!placed))
+        throw Exception::Placement{};
+    return error;
+}
+
 /** Measure the arithmetic mean of the execution time of the given workload with the given transaction library.
  * @param workload     Workload instance to use
  * @param nbthreads    Number of concurrent threads to use
@@ -146,11 +189,15 @@ public:
  * @param maxtick_init Timeout for (re)initialization ('Chrono::invalid_tick' for none)
  * @param maxtick_perf Timeout for performance measurements ('Chrono::invalid_tick' for none)
  * @param maxtick_chck Timeout for correctness check ('Chrono::invalid_tick' for none)
- * @return Error constant null-terminated string ('nullptr' for none), execution times (in ns) (undefined if inconsistency detected)
+ * @param placement    CPU of each thread, cycled through if shorter than the number of threads (empty for no placement)
+ * @param touch        CPUs from which to (re)initialize the shared memory, so that it is first-touched there (empty for initialization by every thread)
+ * @return Error constant null-terminated string ('nullptr' for none), execution times (in ns) (undefined if inconsistency detected), hardware event counts over the performance measurements, time of each repetition (in ns, in run order), throughput of each repetition (in TX/s, in run order)
 **/
-static auto measure(Workload& workload, unsigned int const nbthreads, unsigned int const nbrepeats, Seed seed, Chrono::Tick maxtick_init, Chrono::Tick maxtick_perf, Chrono::Tick maxtick_chck) {
+static auto measure(Workload& workload, unsigned int const nbthreads, unsigned int const nbrepeats, Seed seed, Chrono::Tick maxtick_init, Chrono::Tick maxtick_perf, Chrono::Tick maxtick_chck, ::std::vector<Topology::Cpu> const& placement, ::std::vector<Topology::Cpu> const& touch) {
     ::std::vector<::std::thread> threads(nbthreads);
     ::std::mutex  cerrlock;        // To avoid interleaving writes to 'cerr' in case more than one thread throw
+    ::std::mutex  perflock;        // To merge the hardware event counts of the threads
+    PerfCounts    perf;            // Hardware event counts of all the threads, over the performance measurements
     Sync          sync{nbthreads}; // "As-synchronized-as-possible" starts so that threads interfere "as-much-as-possible"
     
     // We start nbthreads threads to measure performance.
@@ -161,14 +208,30 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
                 // It is devided into a series of small tests. Each test is specified in workload.hpp.
                 // Threads are synchronized between each test so that they run with a lot of concurrency.
                 try {
-                    // 1. Initialization
+                    // 0. Placement
+                    if (!placement.empty() && unlikely(!Topology::pin({placement[i % placement.size()]})))
+                        throw Exception::Placement{};
+
+                    // 1. Initialization (only by the first thread, from the first-touch CPUs, if any: the other threads must not touch the memory first)
                     if (!sync.worker_wait()) return; // Sync. of threads
-                    sync.worker_notify(workload.init()); // Runs the test and tells the master about errors
+                    if (touch.empty())
+                        sync.worker_notify(workload.init()); // Runs the test and tells the master about errors
+                    else
+                        sync.worker_notify(i == 0 ? first_touch(workload, touch) : nullptr);
 
                     // 2. Performance measurements
+                    PerfCounters counters; // Counting only around each run, in this thread
+                    PerfCounts   counts;
                     for (unsigned int count = 0; count < nbrepeats; ++count) {
                         if (!sync.worker_wait()) return;
-                        sync.worker_notify(workload.run(i, seed + nbthreads * count + i));
+                        counters.start();
+                        auto error = workload.run(i, seed + nbthreads * count + i);
+                        counters.stop(counts);
+                        sync.worker_notify(error);
+                    }
+                    { // Merged before this thread notifies the end of its check, hence before the master returns
+                        ::std::unique_lock<decltype(perflock)> guard{perflock};
+                        perf.merge(counts);
                     }
 
                     // 3. Correctness check
@@ -203,6 +266,8 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
         Chrono::Tick time_init = Chrono::invalid_tick;
         Chrono::Tick times[nbrepeats];
         Chrono::Tick time_chck = Chrono::invalid_tick;
+        ::std::vector<Chrono::Tick> repeats; // Before partitioning
+        ::std::vector<double> throughputs; // Of each repetition, the only meaningful sample when repetitions are time-bounded
         auto const posmedian = nbrepeats / 2;
         { // Initialization (with cheap correctness test)
             sync.master_notify(); // We tell workers to start working.
@@ -215,6 +280,7 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
         }
         { // Performance measurements (with cheap correctness tests)
             for (unsigned int i = 0; i < nbrepeats; ++i) {
+                workload.prepare();
                 sync.master_notify();
                 auto res = sync.master_wait(maxtick_perf);
                 if (unlikely(::std::holds_alternative<char const*>(res))) {
@@ -222,6 +288,9 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
                     goto join;
                 }
                 times[i] = ::std::get<Chrono>(res).get_tick();
+                repeats.push_back(times[i]);
+                auto done = workload.collect(); // Workers are done with this repetition
+                throughputs.push_back(static_cast<double>(done) / (static_cast<double>(times[i]) / 1000000000.));
             }
             ::std::nth_element(times, times + posmedian, times + nbrepeats); // Partition times around the median
         }
@@ -239,7 +308,7 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
             for (unsigned int i = 0; i < nbthreads; ++i)
                 threads[i].join();
         }
-        return ::std::make_tuple(error, time_init, times[posmedian], time_chck);
+        return ::std::make_tuple(error, time_init, times[posmedian], time_chck, perf, repeats, throughputs);
     } catch (...) {
         for (unsigned int i = 0; i < nbthreads; ++i) // Detach threads to avoid termination due to attached thread going out of scope
             threads[i].detach();
@@ -247,6 +316,156 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
     }
 }
 
+/** Get the thread counts of a scalability sweep: powers of 2 up to the given maximum, which is always included.
+ * @param nbworkers Maximum number of threads
+ * @return Increasing thread counts
+**/
+static auto sweep_counts(size_t nbworkers) {
+    ::std::vector<size_t> counts;
+    for (size_t count = 1; count < nbworkers; count *= 2)
+        counts.push_back(count);
+    counts.push_back(nbworkers);
+    return counts;
+}
+
+/** Workload parameters that can be set from the command line or a configuration file.
+**/
+using Parameters = ::std::map<::std::string, ::std::string>;
+constexpr static char const* parameter_names[] = {"nbtxperwrk", "nbaccounts", "expnbaccounts", "init_balance", "prob_long", "prob_alloc", "nbrepeats", "slow_factor", "access", "workload", "key_range", "prob_update", "nbbuckets", "load_factor", "prob_resize", "prob_scan", "scan_length", "nbrelations", "nbqueries", "prob_reserve", "nbwarehouses", "nbcustomers", "nbitems"};
+
+/** Check whether a name is the one of a workload parameter.
+ * @param name Name to check
+ * @return Whether it is a workload parameter name
+**/
+static bool is_parameter(::std::string const& name) {
+    return ::std::any_of(::std::begin(parameter_names), ::std::end(parameter_names), [&](char const* known) { return name == known; });
+}
+
+/** Parse an account access distribution: "uniform", "zipf:<theta>" or "hot:<fraction>[:<probability>]" (by default, the hot accounts get 90% of the accesses).
+ * @param text   Null-terminated text to parse
+ * @param access Distribution to set
+ * @return Whether the text is a valid distribution
+**/
+static bool parse_access(char const* text, AccessPattern& access) {
+    auto number = [](char const*& text, double min, double max, double& value) { // Parse a number in [min, max] after a ':'
+        if (*text != ':')
+            return false;
+        char* end;
+        value = ::std::strtod(text + 1, &end);
+        if (end == text + 1 || !(value >= min && value <= max))
+            return false;
+        text = end;
+        return true;
+    };
+    if (::std::strcmp(text, "uniform") == 0) {
+        access = AccessPattern{};
+        return true;
+    }
+    if (::std::strncmp(text, "zipf", 4) == 0) {
+        text += 4;
+        double theta;
+        if (!number(text, 0., 100., theta) || *text != '\0')
+            return false;
+        access = theta > 0. ? AccessPattern::zipf(theta) : AccessPattern{};
+        return true;
+    }
+    if (::std::strncmp(text, "hot", 3) == 0) {
+        text += 3;
+        double fraction;
+        double probability = 0.9;
+        if (!number(text, 0., 1., fraction) || fraction == 0. || (*text != '\0' && !number(text, 0., 1., probability)) || *text != '\0')
+            return false;
+        access = AccessPattern::hotset(fraction, probability);
+        return true;
+    }
+    return false;
+}
+
+/** Describe an account access distribution.
+ * @param access Distribution to describe
+ * @return Description
+**/
+static ::std::string describe_access(AccessPattern const& access) {
+    ::std::ostringstream res;
+    switch (access.get_kind()) {
+    case AccessPattern::Kind::zipf:
+        res << "Zipf (theta " << access.get_theta() << ")";
+        break;
+    case AccessPattern::Kind::hotset:
+        res << "hot set (" << (100. * access.get_hot_fraction()) << "% of the accounts get " << (100. * access.get_hot_probability()) << "% of the accesses)";
+        break;
+    default:
+        res << "uniform";
+    }
+    return res.str();
+}
+
+/** Load the workload parameters of a configuration file, made of 'name = value' lines ('#' starts a comment).
+ * @param path       Path of the configuration file
+ * @param parameters Parameters to set, overwriting the already set ones
+ * @return Error constant null-terminated string ('nullptr' for none)
+**/
+static char const* load_config(char const* path, Parameters& parameters) {
+    ::std::ifstream file{path};
+    if (!file)
+        return "unable to open the file";
+    auto trim = [](::std::string const& text) {
+        auto first = text.find_first_not_of(" \t\r");
+        if (first == ::std::string::npos)
+            return ::std::string{};
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    };
+    ::std::string line;
+    while (::std::getline(file, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+        auto equal = line.find('=');
+        if (equal == ::std::string::npos)
+            return "line without '='";
+        auto name = trim(line.substr(0, equal));
+        if (!is_parameter(name))
+            return "unknown parameter name";
+        parameters[name] = trim(line.substr(equal + 1));
+    }
+    return nullptr;
+}
+
+/** Get the value of a workload parameter, if set.
+ * @param parameters Set parameters
+ * @param name       Name of the parameter
+ * @param value      Default value, replaced by the set value (if any)
+ * @param min        Minimal valid value
+ * @param max        Maximal valid value
+ * @return Whether the parameter is not set or set to a valid value
+**/
+template<class Type> static bool get_parameter(Parameters const& parameters, char const* name, Type& value, Type min, Type max) {
+    auto set = parameters.find(name);
+    if (set == parameters.end())
+        return true;
+    auto const& text = set->second;
+    if (text.empty() || (!::std::is_floating_point_v<Type> && text.find('-') != ::std::string::npos)) // 'stoull' would silently wrap negative numbers
+        return false;
+    size_t end;
+    Type res;
+    try {
+        if constexpr (::std::is_floating_point_v<Type>) {
+            res = static_cast<Type>(::std::stod(text, &end));
+        } else {
+            auto parsed = ::std::stoull(text, &end);
+            if (parsed > static_cast<decltype(parsed)>(::std::numeric_limits<Type>::max()))
+                return false;
+            res = static_cast<Type>(parsed);
+        }
+    } catch (::std::exception const&) { // Not a number, or out of range
+        return false;
+    }
+    if (end != text.size() || !(res >= min && res <= max))
+        return false;
+    value = res;
+    return true;
+}
+
 // -------------------------------------------------------------------------- //
 
 /** Program entry point.
@@ -257,10 +476,111 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
 int main(int argc, char** argv) {
     try {
         // Parse command line option(s)
+        auto const progname = argc > 0 ? argv[0] : "grading";
+        auto durable = false; // Whether to also measure each library on a durable region (if supported)
+        auto sweep   = false; // Whether to also measure each library at increasing thread counts, for the same total work
+        char const* pin_mode = nullptr; // Worker placement: "compact", "scatter", a CPU list, or 'nullptr' for none
+        auto touch_node = -1l; // NUMA node from which to first-touch the shared memory, -1 for none
+        auto format = Report::Format::text;
+        auto duration = 0.; // Duration of each repetition (in s), 0 for a fixed number of transactions per worker
+        auto open_loop = false; // Whether to also measure each library in open loop, at increasing rates
+        ::std::vector<double> open_rates; // Aggregate rates of the open-loop measurements (in TX/s), empty for fractions of the reference throughput
+        char const* config = nullptr; // Last loaded configuration file, 'nullptr' for none
+        Parameters parameters; // Workload parameters set so far, the last setting of each taking precedence
+        while (argc > 1 && ::std::strncmp(argv[1], "--", 2) == 0) {
+            if (::std::strcmp(argv[1], "--durable") == 0) {
+                durable = true;
+            } else if (::std::strcmp(argv[1], "--sweep") == 0) {
+                sweep = true;
+            } else if (::std::strncmp(argv[1], "--pin=", 6) == 0) {
+                pin_mode = argv[1] + 6;
+            } else if (::std::strncmp(argv[1], "--first-touch=", 14) == 0) {
+                char* end;
+                touch_node = ::std::strtol(argv[1] + 14, &end, 10);
+                if (*end != '\0' || end == argv[1] + 14 || touch_node < 0 || touch_node > 65535) {
+                    ::std::cout << "Invalid NUMA node '" << (argv[1] + 14) << "'" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strncmp(argv[1], "--duration=", 11) == 0) {
+                char* end;
+                duration = ::std::strtod(argv[1] + 11, &end);
+                if (*end != '\0' || !(duration > 0. && duration < 1e6)) {
+                    ::std::cout << "Invalid duration '" << (argv[1] + 11) << "'" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strcmp(argv[1], "--open-loop") == 0) {
+                open_loop = true;
+            } else if (::std::strncmp(argv[1], "--open-loop=", 12) == 0) {
+                open_loop = true;
+                open_rates.clear();
+                for (char const* list = argv[1] + 12;;) {
+                    char* end;
+                    auto rate = ::std::strtod(list, &end);
+                    if (end == list || !(rate > 0.) || (*end != ',' && *end != '\0')) {
+                        ::std::cout << "Invalid open-loop rates '" << (argv[1] + 12) << "'" << ::std::endl;
+                        return 1;
+                    }
+                    open_rates.push_back(rate);
+                    if (*end == '\0')
+                        break;
+                    list = end + 1;
+                }
+            } else if (::std::strncmp(argv[1], "--config=", 9) == 0) {
+                config = argv[1] + 9;
+                auto error = load_config(config, parameters);
+                if (error) {
+                    ::std::cout << "Invalid configuration file '" << config << "': " << error << ::std::endl;
+                    return 1;
+                }
+            } else if (auto equal = ::std::strchr(argv[1], '='); equal && is_parameter(::std::string(argv[1] + 2, equal))) {
+                parameters[::std::string(argv[1] + 2, equal)] = equal + 1;
+            } else if (::std::strcmp(argv[1], "--format=text") == 0) {
+                format = Report::Format::text;
+            } else if (::std::strcmp(argv[1], "--format=json") == 0) {
+                format = Report::Format::json;
+            } else if (::std::strcmp(argv[1], "--format=csv") == 0) {
+                format = Report::Format::csv;
+            } else {
+                ::std::cout << "Unknown option '" << argv[1] << "'" << ::std::endl;
+                return 1;
+            }
+            --argc;
+            ++argv;
+        }
         if (argc < 3) {
-            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " <seed> <reference library path> <tested library path>..." << ::std::endl;
+            ::std::cout << "Usage: " << progname << " [--durable] [--sweep] [--pin=compact|scatter|<cpu list>] [--first-touch=<numa node>] [--duration=<seconds>] [--open-loop[=<TX/s>,...]] [--format=text|json|csv] [--config=<file>] [--<workload parameter>=<value>] <seed> <reference library path> <tested library path>..." << ::std::endl;
             return 1;
         }
+        // Resolve thread placement
+        ::std::vector<Topology::Cpu> placement;
+        if (pin_mode) {
+            if (::std::strcmp(pin_mode, "compact") == 0) {
+                placement = Topology::compact();
+            } else if (::std::strcmp(pin_mode, "scatter") == 0) {
+                placement = Topology::scatter();
+            } else {
+                placement = Topology::parse_list(pin_mode);
+                auto permitted = Topology::allowed();
+                for (auto cpu: placement) {
+                    if (!::std::binary_search(permitted.begin(), permitted.end(), cpu)) { // Not a CPU we may run on
+                        placement.clear();
+                        break;
+                    }
+                }
+            }
+            if (placement.empty()) {
+                ::std::cout << "Invalid worker placement '" << pin_mode << "'" << ::std::endl;
+                return 1;
+            }
+        }
+        ::std::vector<Topology::Cpu> touch_cpus;
+        if (touch_node >= 0) {
+            touch_cpus = Topology::node(touch_node);
+            if (touch_cpus.empty()) {
+                ::std::cout << "No usable CPU on NUMA node " << touch_node << ::std::endl;
+                return 1;
+            }
+        }
         // Get/set/compute run parameters
         auto const nbworkers = []() {
             auto res = ::std::thread::hardware_concurrency();
@@ -268,60 +588,297 @@ int main(int argc, char** argv) {
                 res = 16;
             return static_cast<size_t>(res);
         }();
-        auto const nbtxperwrk    = 200000ul / nbworkers;
-        auto const nbaccounts    = 32 * nbworkers;
-        auto const expnbaccounts = 256 * nbworkers;
-        auto const init_balance  = 100ul;
-        auto const prob_long     = 0.5f;
-        auto const prob_alloc    = 0.01f;
-        auto const nbrepeats     = 7;
-        auto const seed          = static_cast<Seed>(::std::stoul(argv[1]));
-        auto const clk_res       = Chrono::get_resolution();
-        auto const slow_factor   = 16ul;
+        auto nbtxperwrk    = 200000ul / nbworkers;
+        auto nbaccounts    = 32 * nbworkers;
+        auto expnbaccounts = 256 * nbworkers;
+        auto init_balance  = WorkloadBank::Balance{100};
+        auto prob_long     = 0.5f;
+        auto prob_alloc    = 0.01f;
+        auto nbrepeats     = 7u;
+        auto const seed    = static_cast<Seed>(::std::stoul(argv[1]));
+        auto const clk_res = Chrono::get_resolution();
+        auto slow_factor   = 16ul;
+        AccessPattern access; // Uniform unless set
+        auto key_range     = 1024ul;
+        auto prob_update   = 0.2f;
+        auto nbbuckets     = 1024ul;
+        auto load_factor   = 1.f;
+        auto prob_resize   = 0.0005f;
+        auto prob_scan     = 0.1f;
+        auto scan_length   = 64ul;
+        auto nbrelations   = 1024ul;
+        auto nbqueries     = 4ul;
+        auto prob_reserve  = 0.9f;
+        auto nbwarehouses  = (nbworkers + 9) / 10; // 10 terminals per warehouse, as in TPC-C
+        auto nbcustomers   = 300ul;
+        auto nbitems       = 10000ul;
+        ::std::string workload_name{"bank"};
+        { // Overwrite with the set workload parameters
+            auto invalid = [&](char const* name) {
+                ::std::cout << "Invalid value '" << parameters[name] << "' for parameter '" << name << "'" << ::std::endl;
+                return 1;
+            };
+            constexpr auto size_max = ::std::numeric_limits<size_t>::max();
+            if (!get_parameter<size_t>(parameters, "nbtxperwrk", nbtxperwrk, 1, size_max))
+                return invalid("nbtxperwrk");
+            if (!get_parameter<size_t>(parameters, "nbaccounts", nbaccounts, 1, size_max))
+                return invalid("nbaccounts");
+            if (!get_parameter<size_t>(parameters, "expnbaccounts", expnbaccounts, 1, size_max))
+                return invalid("expnbaccounts");
+            if (!get_parameter<WorkloadBank::Balance>(parameters, "init_balance", init_balance, 0, ::std::numeric_limits<int32_t>::max())) // Keeps the total balance far from overflowing
+                return invalid("init_balance");
+            if (!get_parameter<float>(parameters, "prob_long", prob_long, 0.f, 1.f))
+                return invalid("prob_long");
+            if (!get_parameter<float>(parameters, "prob_alloc", prob_alloc, 0.f, 1.f))
+                return invalid("prob_alloc");
+            if (!get_parameter<unsigned int>(parameters, "nbrepeats", nbrepeats, 1, 1000)) // Repetition times are kept on the stack
+                return invalid("nbrepeats");
+            if (!get_parameter<unsigned long>(parameters, "slow_factor", slow_factor, 1, 1ul << 20))
+                return invalid("slow_factor");
+            if (parameters.count("access") > 0 && !parse_access(parameters["access"].c_str(), access))
+                return invalid("access");
+            if (parameters.count("workload") > 0) {
+                workload_name = parameters["workload"];
+                if (workload_name != "bank" && workload_name != "list" && workload_name != "hashmap" && workload_name != "skiplist" && workload_name != "btree" && workload_name != "vacation" && workload_name != "tpcc")
+                    return invalid("workload");
+            }
+            if (!get_parameter<size_t>(parameters, "key_range", key_range, 1, size_t{1} << 40)) // Keeps the private keys of the checks representable
+                return invalid("key_range");
+            if (!get_parameter<float>(parameters, "prob_update", prob_update, 0.f, 1.f))
+                return invalid("prob_update");
+            if (!get_parameter<size_t>(parameters, "nbbuckets", nbbuckets, 1, size_t{1} << 32))
+                return invalid("nbbuckets");
+            if (!get_parameter<float>(parameters, "load_factor", load_factor, 0.f, 64.f))
+                return invalid("load_factor");
+            if (!get_parameter<float>(parameters, "prob_resize", prob_resize, 0.f, 1.f))
+                return invalid("prob_resize");
+            if (!get_parameter<float>(parameters, "prob_scan", prob_scan, 0.f, 1.f))
+                return invalid("prob_scan");
+            if (!get_parameter<size_t>(parameters, "scan_length", scan_length, 1, size_t{1} << 32))
+                return invalid("scan_length");
+            if (!get_parameter<size_t>(parameters, "nbrelations", nbrelations, 1, size_t{1} << 32))
+                return invalid("nbrelations");
+            if (!get_parameter<size_t>(parameters, "nbqueries", nbqueries, 1, 1024))
+                return invalid("nbqueries");
+            if (!get_parameter<float>(parameters, "prob_reserve", prob_reserve, 0.f, 1.f))
+                return invalid("prob_reserve");
+            if (!get_parameter<size_t>(parameters, "nbwarehouses", nbwarehouses, 1, 1024))
+                return invalid("nbwarehouses");
+            if (!get_parameter<size_t>(parameters, "nbcustomers", nbcustomers, 1, size_t{1} << 24))
+                return invalid("nbcustomers");
+            if (!get_parameter<size_t>(parameters, "nbitems", nbitems, 1, size_t{1} << 24))
+                return invalid("nbitems");
+        }
         // Print run parameters
-        ::std::cout << "⎧ #worker threads:     " << nbworkers << ::std::endl;
-        ::std::cout << "⎪ #TX per worker:      " << nbtxperwrk << ::std::endl;
-        ::std::cout << "⎪ #repetitions:        " << nbrepeats << ::std::endl;
-        ::std::cout << "⎪ Initial #accounts:   " << nbaccounts << ::std::endl;
-        ::std::cout << "⎪ Expected #accounts:  " << expnbaccounts << ::std::endl;
-        ::std::cout << "⎪ Initial balance:     " << init_balance << ::std::endl;
-        ::std::cout << "⎪ Long TX probability: " << prob_long << ::std::endl;
-        ::std::cout << "⎪ Allocation TX prob.: " << prob_alloc << ::std::endl;
-        ::std::cout << "⎪ Slow trigger factor: " << slow_factor << ::std::endl;
-        ::std::cout << "⎪ Clock resolution:    ";
+        Report report{format};
+        auto& out = report.text();
+        auto fail = [&](::std::string const& error) { // Report an error of the current library, then return the program code
+            out << "⎩ " << error << ::std::endl;
+            report.add("error", error);
+            report.print(::std::cout);
+            return 1;
+        };
+        out << "⎧ #worker threads:     " << nbworkers << ::std::endl;
+        out << "⎪ #TX per worker:      " << nbtxperwrk << (duration > 0. ? " (unused, time-bounded)" : "") << ::std::endl;
+        out << "⎪ #repetitions:        " << nbrepeats << ::std::endl;
+        out << "⎪ Workload:            " << workload_name << ::std::endl;
+        if (workload_name == "bank") {
+            out << "⎪ Initial #accounts:   " << nbaccounts << ::std::endl;
+            out << "⎪ Expected #accounts:  " << expnbaccounts << ::std::endl;
+            out << "⎪ Initial balance:     " << init_balance << ::std::endl;
+            out << "⎪ Long TX probability: " << prob_long << ::std::endl;
+            out << "⎪ Allocation TX prob.: " << prob_alloc << ::std::endl;
+            out << "⎪ Account access:      " << describe_access(access) << ::std::endl;
+        } else if (workload_name == "tpcc") {
+            out << "⎪ #warehouses:         " << nbwarehouses << ::std::endl;
+            out << "⎪ #customers/district: " << nbcustomers << ::std::endl;
+            out << "⎪ #items:              " << nbitems << ::std::endl;
+            out << "⎪ Access pattern:      " << describe_access(access) << ::std::endl;
+        } else if (workload_name == "vacation") {
+            out << "⎪ #items per kind:     " << nbrelations << " (and as many initial customers)" << ::std::endl;
+            out << "⎪ #items per TX:       " << nbqueries << ::std::endl;
+            out << "⎪ Reservation prob.:   " << prob_reserve << " (the rest equally customer deletions and admin updates)" << ::std::endl;
+            out << "⎪ Item access:         " << describe_access(access) << ::std::endl;
+        } else {
+            if (workload_name == "hashmap") {
+                out << "⎪ Initial #buckets:    " << nbbuckets << ::std::endl;
+                out << "⎪ Initial load factor: " << load_factor << " (keys drawn from twice as many)" << ::std::endl;
+                out << "⎪ Resize probability:  " << prob_resize << ::std::endl;
+            } else {
+                out << "⎪ Key range:           " << key_range << " (half initially in the set)" << ::std::endl;
+            }
+            if (workload_name == "skiplist") {
+                out << "⎪ Range scan prob.:    " << prob_scan << ::std::endl;
+                out << "⎪ Range scan length:   " << scan_length << ::std::endl;
+            }
+            out << "⎪ Update probability:  " << prob_update << ::std::endl;
+            out << "⎪ Key access:          " << describe_access(access) << ::std::endl;
+        }
+        out << "⎪ Slow trigger factor: " << slow_factor << ::std::endl;
+        out << "⎪ Configuration file:  " << (config ? config : "none") << ::std::endl;
+        out << "⎪ Time bound:          ";
+        if (duration > 0.) {
+            out << duration << " s per repetition" << ::std::endl;
+            report.add("duration_s", duration);
+        } else {
+            out << "none" << ::std::endl;
+            report.add("duration_s", nullptr);
+        }
+        out << "⎪ Open loop:           ";
+        if (!open_loop) {
+            out << "no" << ::std::endl;
+            report.add("open_loop_rates", nullptr);
+        } else if (open_rates.empty()) {
+            out << "10% to 110% of the reference throughput" << ::std::endl;
+            report.add("open_loop_rates", "reference");
+        } else {
+            for (size_t i = 0; i < open_rates.size(); ++i)
+                out << (i > 0 ? ", " : "") << open_rates[i];
+            out << " TX/s" << ::std::endl;
+            report.add("open_loop_rates", open_rates);
+        }
+        out << "⎪ Clock resolution:    ";
         if (unlikely(clk_res == Chrono::invalid_tick)) {
-            ::std::cout << "<unknown>" << ::std::endl;
+            out << "<unknown>" << ::std::endl;
+            report.add("clock_resolution_ns", nullptr);
+        } else {
+            out << clk_res << " ns" << ::std::endl;
+            report.add("clock_resolution_ns", clk_res);
+        }
+        out << "⎪ Durable variant:     " << (durable ? "yes" : "no") << ::std::endl;
+        out << "⎪ Thread sweep:        " << (sweep ? "yes" : "no") << ::std::endl;
+        out << "⎪ Worker placement:    ";
+        if (placement.empty()) {
+            out << "none" << ::std::endl;
+            report.add("placement", nullptr);
+        } else {
+            out << pin_mode << " (CPUs " << Topology::format_list(placement) << ")" << ::std::endl;
+            report.add("placement", Topology::format_list(placement));
+        }
+        out << "⎪ First-touch node:    ";
+        if (touch_cpus.empty()) {
+            out << "none" << ::std::endl;
+            report.add("first_touch_node", nullptr);
+        } else {
+            out << touch_node << " (CPUs " << Topology::format_list(touch_cpus) << ")" << ::std::endl;
+            report.add("first_touch_node", touch_node);
+        }
+        out << "⎩ Seed value:          " << seed << ::std::endl;
+        report.add("nbworkers", nbworkers);
+        report.add("nbtxperwrk", nbtxperwrk);
+        report.add("nbrepeats", nbrepeats);
+        report.add("workload", workload_name);
+        if (workload_name == "bank") {
+            report.add("nbaccounts", nbaccounts);
+            report.add("expnbaccounts", expnbaccounts);
+            report.add("init_balance", init_balance);
+            report.add("prob_long", prob_long);
+            report.add("prob_alloc", prob_alloc);
+        } else if (workload_name == "tpcc") {
+            report.add("nbwarehouses", nbwarehouses);
+            report.add("nbcustomers", nbcustomers);
+            report.add("nbitems", nbitems);
+        } else if (workload_name == "vacation") {
+            report.add("nbrelations", nbrelations);
+            report.add("nbqueries", nbqueries);
+            report.add("prob_reserve", prob_reserve);
         } else {
-            ::std::cout << clk_res << " ns" << ::std::endl;
+            if (workload_name == "hashmap") {
+                report.add("nbbuckets", nbbuckets);
+                report.add("load_factor", load_factor);
+                report.add("prob_resize", prob_resize);
+            } else {
+                report.add("key_range", key_range);
+            }
+            if (workload_name == "skiplist") {
+                report.add("prob_scan", prob_scan);
+                report.add("scan_length", scan_length);
+            }
+            report.add("prob_update", prob_update);
         }
-        ::std::cout << "⎩ Seed value:          " << seed << ::std::endl;
+        report.add("slow_factor", slow_factor);
+        report.add("access", describe_access(access));
+        if (config) {
+            report.add("config", config);
+        } else {
+            report.add("config", nullptr);
+        }
+        report.add("durable", durable);
+        report.add("sweep", sweep);
+        report.add("seed", seed);
+        // Workload instantiation (shared memory lifetime bound to workload: created and destroyed at the same time)
+        auto make_workload = [&](TransactionalLibrary const& tl, size_t nbthreads, size_t nbtxperthread, char const* logpath = nullptr, ::std::optional<float> update = ::std::nullopt) -> ::std::unique_ptr<Workload> {
+            auto ratio = update.value_or(prob_update); // Update probability of the set workloads
+            if (workload_name == "hashmap")
+                return ::std::make_unique<WorkloadHashMap>(tl, nbthreads, nbtxperthread, nbbuckets, load_factor, ratio, prob_resize, access, logpath);
+            if (workload_name == "tpcc")
+                return ::std::make_unique<WorkloadTpcc>(tl, nbthreads, nbtxperthread, nbwarehouses, nbcustomers, nbitems, access, logpath);
+            if (workload_name == "vacation")
+                return ::std::make_unique<WorkloadVacation>(tl, nbthreads, nbtxperthread, nbrelations, nbqueries, prob_reserve, access, logpath);
+            if (workload_name == "btree")
+                return ::std::make_unique<WorkloadBTree>(tl, nbthreads, nbtxperthread, key_range, ratio, access, logpath);
+            if (workload_name == "skiplist")
+                return ::std::make_unique<WorkloadSkipList>(tl, nbthreads, nbtxperthread, key_range, ratio, prob_scan, scan_length, access, logpath);
+            if (workload_name == "list")
+                return ::std::make_unique<WorkloadLinkedList>(tl, nbthreads, nbtxperthread, key_range, ratio, access, logpath);
+            return ::std::make_unique<WorkloadBank>(tl, nbthreads, nbtxperthread, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc, access, logpath);
+        };
+        struct Variant { // Result of the measurement of a workload variant
+            ::std::optional<::std::string> error; // Error, labeled with the variant, if any
+            double median;     // Median time of a repetition (in ns)
+            double throughput; // Throughput over the repetitions (in TX/s)
+        };
+        auto measure_variant = [&](Workload& variant, size_t nbthreads, ::std::string const& label, ::std::string const& prefix) { // Measure a variant of the workload (no timeout), and report its times and throughput under the given prefix
+            Variant res{::std::nullopt, 0., 0.};
+            auto measured = measure(variant, nbthreads, nbrepeats, seed, Chrono::invalid_tick, Chrono::invalid_tick, Chrono::invalid_tick, placement, touch_cpus);
+            if (unlikely(::std::get<0>(measured))) {
+                res.error = ::std::string{::std::get<0>(measured)} + " (" + label + ")";
+                return res;
+            }
+            res.median     = static_cast<double>(::std::get<2>(measured));
+            res.throughput = static_cast<double>(variant.get_done()) / static_cast<double>(nbrepeats) / (res.median / 1000000000.);
+            report.add(prefix + "_times_ns", ::std::get<5>(measured));
+            report.add(prefix + "_throughputs", ::std::get<6>(measured));
+            report.add(prefix + "_median_ns", ::std::get<2>(measured));
+            report.add(prefix + "_throughput", res.throughput);
+            return res;
+        };
         // Library evaluations
-        double reference = 0.; // Set to avoid irrelevant '-Wmaybe-uninitialized'
-        auto const pertxdiv = static_cast<double>(nbworkers) * static_cast<double>(nbtxperwrk);
+        double reference = 0.; // Average TX execution time of the reference, set to avoid irrelevant '-Wmaybe-uninitialized'
+        double reference_throughput = 0.; // Throughput of the reference (in TX/s)
+        auto const duration_tick = static_cast<Chrono::Tick>(duration * 1000000000.);
         auto maxtick_init = Chrono::invalid_tick;
         auto maxtick_perf = Chrono::invalid_tick;
         auto maxtick_chck = Chrono::invalid_tick;
         for (auto i = 2; i < argc; ++i) {
-            ::std::cout << "⎧ Evaluating '" << argv[i] << "'" << (maxtick_init == Chrono::invalid_tick ? " (reference)" : "") << "..." << ::std::endl;
+            out << "⎧ Evaluating '" << argv[i] << "'" << (maxtick_init == Chrono::invalid_tick ? " (reference)" : "") << "..." << ::std::endl;
+            report.open_library();
+            report.add("path", argv[i]);
+            report.add("reference", maxtick_init == Chrono::invalid_tick);
             // Load TM library
             TransactionalLibrary tl{argv[i]};
-            // Initialize workload (shared memory lifetime bound to workload: created and destroyed at the same time)
-            WorkloadBank bank{tl, nbworkers, nbtxperwrk, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc};
+            // Initialize workload
+            auto workload = make_workload(tl, nbworkers, nbtxperwrk);
+            workload->set_duration(duration_tick);
             try {
                 // Actual performance measurements and correctness check
-                auto res = measure(bank, nbworkers, nbrepeats, seed, maxtick_init, maxtick_perf, maxtick_chck);
+                auto res = measure(*workload, nbworkers, nbrepeats, seed, maxtick_init, maxtick_perf, maxtick_chck, placement, touch_cpus);
                 // Check false negative-free correctness
                 auto error = ::std::get<0>(res);
-                if (unlikely(error)) {
-                    ::std::cout << "⎩ " << error << ::std::endl;
-                    return 1;
-                }
+                if (unlikely(error))
+                    return fail(error);
                 // Print results
                 auto tick_init = ::std::get<1>(res);
                 auto tick_perf = ::std::get<2>(res);
                 auto tick_chck = ::std::get<3>(res);
                 auto perfdbl = static_cast<double>(tick_perf);
-                ::std::cout << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
+                auto pertxdiv = static_cast<double>(workload->get_done()) / static_cast<double>(nbrepeats); // Average number of TX per repetition
+                report.add("init_ns", tick_init);
+                report.add("check_ns", tick_chck);
+                report.add("times_ns", ::std::get<5>(res));
+                report.add("throughputs", ::std::get<6>(res));
+                report.add("median_ns", tick_perf);
+                out << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
                 if (maxtick_init == Chrono::invalid_tick) { // Set reference performance
                     maxtick_init = slow_factor * tick_init;
                     if (unlikely(maxtick_init == Chrono::invalid_tick)) // Bad luck...
@@ -332,12 +889,174 @@ int main(int argc, char** argv) {
                     maxtick_chck = slow_factor * tick_chck;
                     if (unlikely(maxtick_chck == Chrono::invalid_tick)) // Bad luck...
                         ++maxtick_chck;
-                    reference = perfdbl;
+                    reference = perfdbl / pertxdiv;
+                    reference_throughput = pertxdiv / (perfdbl / 1000000000.);
                 } else { // Compare with reference performance
-                    ::std::cout << " -> " << (reference / perfdbl) << " speedup";
+                    out << " -> " << (reference * pertxdiv / perfdbl) << " speedup";
+                    report.add("speedup", reference * pertxdiv / perfdbl);
+                }
+                out << ::std::endl;
+                report.add("tx_per_s", pertxdiv / (perfdbl / 1000000000.));
+                if (workload_name == "tpcc") { // New orders per minute, over every repetition
+                    auto const& times = ::std::get<5>(res);
+                    auto total = static_cast<double>(::std::accumulate(times.begin(), times.end(), Chrono::Tick{0}));
+                    auto tpmc = static_cast<double>(workload->get_attempts(0).get_commits()) / (total / 60000000000.);
+                    out << "⎪ tpmC:             " << tpmc << " new-order TX/min (" << (60. * pertxdiv / (perfdbl / 1000000000.)) << " TX/min in total)" << ::std::endl;
+                    report.add("tpmc", tpmc);
+                }
+                if (duration > 0.) { // Per-thread progress exposes starvation, hidden when every thread runs the same number of TX
+                    ::std::vector<uint_fast64_t> done;
+                    for (Uid uid = 0; uid < nbworkers; ++uid)
+                        done.push_back(workload->get_done(uid));
+                    auto minmax = ::std::minmax_element(done.begin(), done.end());
+                    out << "⎪ Throughput:       " << (pertxdiv / (perfdbl / 1000000000.)) << " TX/s" << ::std::endl;
+                    out << "⎪ TX per thread:    min " << *minmax.first << ", max " << *minmax.second << " (" << (*minmax.second > 0 ? static_cast<double>(*minmax.first) / static_cast<double>(*minmax.second) : 0.) << " fairness):";
+                    for (auto count: done)
+                        out << " " << count;
+                    out << ::std::endl;
+                    report.add("tx_per_worker", done);
+                }
+                TransactionalMemory::Stats stats;
+                if (workload->get_stats(stats)) { // Counters since the creation of the region, i.e. including initialization and checks
+                    auto aborts = stats.aborts_read + stats.aborts_write + stats.aborts_alloc;
+                    auto commit_ns = stats.commits > 0 ? static_cast<double>(stats.commit_time) / static_cast<double>(stats.commits) : 0.;
+                    out << "⎪ Committed TX:     " << stats.commits << " (" << commit_ns << " ns/commit)" << ::std::endl;
+                    out << "⎪ Aborted TX:       " << aborts << " (" << stats.aborts_read << " read validation, " << stats.aborts_write << " write lock, " << stats.aborts_alloc << " alloc)" << ::std::endl;
+                    report.add("commits", stats.commits);
+                    report.add("commit_ns", commit_ns);
+                    report.add("aborts_read", stats.aborts_read);
+                    report.add("aborts_write", stats.aborts_write);
+                    report.add("aborts_alloc", stats.aborts_alloc);
+                }
+                for (size_t type = 0; type < workload->get_nbtypes(); ++type) { // Latencies over every repetition, retries included
+                    auto const& latency = workload->get_latency(type);
+                    if (latency.get_count() == 0)
+                        continue;
+                    out << "⎪ Latency " << workload->get_type_name(type) << " TX: p50 " << latency.get_quantile(0.5) << " ns, p99 " << latency.get_quantile(0.99) << " ns, p99.9 " << latency.get_quantile(0.999) << " ns, max " << latency.get_max() << " ns (" << latency.get_count() << " TX)" << ::std::endl;
+                    auto prefix = ::std::string{"latency_"} + workload->get_type_name(type);
+                    report.add(prefix + "_count", latency.get_count());
+                    report.add(prefix + "_p50_ns", latency.get_quantile(0.5));
+                    report.add(prefix + "_p99_ns", latency.get_quantile(0.99));
+                    report.add(prefix + "_p999_ns", latency.get_quantile(0.999));
+                    report.add(prefix + "_max_ns", latency.get_max());
+                }
+                for (size_t type = 0; type < workload->get_nbtypes(); ++type) { // Attempts over every repetition
+                    auto const& attempts = workload->get_attempts(type);
+                    if (attempts.get_attempts() == 0)
+                        continue;
+                    out << "⎪ Attempts " << workload->get_type_name(type) << " TX: " << attempts.get_attempts() << " (" << attempts.get_commits() << " commits, " << attempts.get_retries() << " retries, " << (100. * static_cast<double>(attempts.get_retries()) / static_cast<double>(attempts.get_attempts())) << "% aborted); retries per TX:";
+                    ::std::vector<uint_fast64_t> distribution;
+                    for (size_t nbretries = 0; nbretries < Attempts::nbbuckets; ++nbretries) {
+                        auto count = attempts.get_bucket(nbretries);
+                        distribution.push_back(count);
+                        if (count > 0)
+                            out << " " << nbretries << (nbretries + 1 == Attempts::nbbuckets ? "+" : "") << " (" << (100. * static_cast<double>(count) / static_cast<double>(attempts.get_commits())) << "%)";
+                    }
+                    out << ::std::endl;
+                    auto prefix = ::std::string{"attempts_"} + workload->get_type_name(type);
+                    report.add(prefix, attempts.get_attempts());
+                    report.add(prefix + "_commits", attempts.get_commits());
+                    report.add(prefix + "_retries", attempts.get_retries());
+                    report.add(prefix + "_retry_distribution", distribution);
+                }
+                if (durable && tl.has_durable()) { // Same workload on a durable region, logged in a temporary file of the working directory
+                    char logpath[] = "grading-wal-XXXXXX";
+                    auto fd = ::mkstemp(logpath);
+                    if (unlikely(fd < 0))
+                        throw Exception::TransactionCreate{"unable to create a temporary log file"};
+                    ::close(fd);
+                    Variant durable_res;
+                    { // The region is destroyed before its log file is removed
+                        auto durable_workload = make_workload(tl, nbworkers, nbtxperwrk, logpath);
+                        durable_workload->set_duration(duration_tick);
+                        durable_res = measure_variant(*durable_workload, nbworkers, "durable region", "durable");
+                    }
+                    ::unlink(logpath);
+                    if (unlikely(durable_res.error))
+                        return fail(*durable_res.error);
+                    auto durable_txtime = 1000000000. / durable_res.throughput;
+                    auto txtime = perfdbl / pertxdiv;
+                    out << "⎪ Durable user execution time: " << (durable_res.median / 1000000.) << " ms -> " << (durable_txtime / txtime) << " slowdown" << ::std::endl;
+                    out << "⎪ Durability cost per TX: " << (durable_txtime - txtime) << " ns" << ::std::endl;
+                    report.add("durable_slowdown", durable_txtime / txtime);
+                    report.add("durable_cost_ns", durable_txtime - txtime);
+                }
+                if (sweep) { // Same total work and shared data, spread over fewer threads
+                    double sweep_base = 0.; // Throughput with 1 thread (in TX/s)
+                    for (auto nbsweepers: sweep_counts(nbworkers)) {
+                        auto const nbsweeptx = nbworkers * nbtxperwrk / nbsweepers;
+                        auto sweep_workload = make_workload(tl, nbsweepers, nbsweeptx);
+                        sweep_workload->set_duration(duration_tick);
+                        auto prefix = "sweep_" + ::std::to_string(nbsweepers);
+                        auto sweep_res = measure_variant(*sweep_workload, nbsweepers, ::std::to_string(nbsweepers) + " threads", prefix);
+                        if (unlikely(sweep_res.error))
+                            return fail(*sweep_res.error);
+                        auto throughput = sweep_res.throughput;
+                        if (nbsweepers == 1)
+                            sweep_base = throughput;
+                        out << "⎪ Sweep " << nbsweepers << " threads: " << (sweep_res.median / 1000000.) << " ms, " << throughput << " TX/s -> " << (throughput / sweep_base) << " speedup, " << (100. * throughput / sweep_base / static_cast<double>(nbsweepers)) << "% efficiency" << ::std::endl;
+                        report.add(prefix + "_speedup", throughput / sweep_base);
+                    }
+                }
+                if (open_loop) { // Same workload issued at fixed aggregate rates, for a throughput-latency curve
+                    auto const open_tick = duration > 0. ? duration_tick : Chrono::Tick{250000000}; // Open loop needs time-bounded repetitions
+                    auto rates = open_rates;
+                    if (rates.empty()) {
+                        for (auto fraction: {0.1, 0.25, 0.5, 0.75, 0.9, 1.0, 1.1})
+                            rates.push_back(fraction * reference_throughput);
+                    }
+                    for (size_t point = 0; point < rates.size(); ++point) {
+                        auto open_workload = make_workload(tl, nbworkers, nbtxperwrk);
+                        open_workload->set_duration(open_tick);
+                        open_workload->set_rate(rates[point]);
+                        auto prefix = "open_loop_" + ::std::to_string(point);
+                        report.add(prefix + "_offered", rates[point]);
+                        auto open_res = measure_variant(*open_workload, nbworkers, "open loop", prefix);
+                        if (unlikely(open_res.error))
+                            return fail(*open_res.error);
+                        Histogram latency; // Every transaction type
+                        for (size_t type = 0; type < open_workload->get_nbtypes(); ++type)
+                            latency.merge(open_workload->get_latency(type));
+                        out << "⎪ Open loop " << rates[point] << " TX/s offered: " << open_res.throughput << " TX/s achieved, p50 " << latency.get_quantile(0.5) << " ns, p99 " << latency.get_quantile(0.99) << " ns, p99.9 " << latency.get_quantile(0.999) << " ns" << ::std::endl;
+                        report.add(prefix + "_p50_ns", latency.get_quantile(0.5));
+                        report.add(prefix + "_p99_ns", latency.get_quantile(0.99));
+                        report.add(prefix + "_p999_ns", latency.get_quantile(0.999));
+                    }
+                }
+                if (workload_name == "btree") { // Same tree at increasing update ratios, from read-only to update-only
+                    for (auto ratio: {0.f, 0.1f, 0.5f, 1.f}) {
+                        auto ratio_workload = make_workload(tl, nbworkers, nbtxperwrk, nullptr, ratio);
+                        ratio_workload->set_duration(duration_tick);
+                        auto percent = ::std::to_string(static_cast<int>(100.f * ratio));
+                        auto ratio_res = measure_variant(*ratio_workload, nbworkers, percent + "% updates", "update_" + percent);
+                        if (unlikely(ratio_res.error))
+                            return fail(*ratio_res.error);
+                        out << "⎪ Update ratio " << percent << "%: " << (ratio_res.median / 1000000.) << " ms, " << ratio_res.throughput << " TX/s" << ::std::endl;
+                    }
+                }
+                { // Hardware events per transaction, over every repetition
+                    auto const& counts = ::std::get<4>(res);
+                    auto const nbtx = static_cast<double>(workload->get_done());
+                    auto first = true;
+                    out << "⎪ Hardware events per TX: ";
+                    for (size_t event = 0; event < PerfCounts::nbevents; ++event) {
+                        if (!counts.is_valid(event))
+                            continue;
+                        out << (first ? "" : ", ") << (static_cast<double>(counts.get(event)) / nbtx) << " " << PerfCounts::get_name(event);
+                        report.add(::std::string{PerfCounts::get_key(event)} + "_per_tx", static_cast<double>(counts.get(event)) / nbtx);
+                        first = false;
+                    }
+                    if (first) {
+                        out << "unavailable (" << ::std::strerror(counts.get_error()) << ")";
+                    } else if (counts.is_valid(PerfCounts::cycles) && counts.is_valid(PerfCounts::instructions) && counts.get(PerfCounts::cycles) > 0) {
+                        auto ipc = static_cast<double>(counts.get(PerfCounts::instructions)) / static_cast<double>(counts.get(PerfCounts::cycles));
+                        out << " (" << ipc << " IPC)";
+                        report.add("ipc", ipc);
+                    }
+                    out << ::std::endl;
                 }
-                ::std::cout << ::std::endl;
-                ::std::cout << "⎩ Average TX execution time: " << (perfdbl / pertxdiv) << " ns" << ::std::endl;
+                out << "⎩ Average TX execution time: " << (perfdbl / pertxdiv) << " ns" << ::std::endl;
+                report.add("avg_tx_ns", perfdbl / pertxdiv);
             } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit
                 ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl;
                 ::std::cerr << "⎩ " << err.what() << ::std::endl;
@@ -348,6 +1067,7 @@ int main(int argc, char** argv) {
 #endif
             }
         }
+        report.print(::std::cout);
         return 0;
     } catch (::std::exception const& err) {
         ::std::cerr << "⎧ *** EXCEPTION ***" << ::std::endl;
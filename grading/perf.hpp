@@ -0,0 +1,225 @@
+/**
+ * @file   perf.hpp
+ * @author Sébastien Rouault <sebastien.rouault@epfl.ch>
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Per-thread hardware performance counters, through Linux 'perf_event_open'.
+**/
+
+#pragma once
+
+// External headers
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+extern "C" {
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Counts of hardware events, summed over threads and time segments.
+**/
+class PerfCounts final {
+public:
+    /** Counted events.
+    **/
+    enum Event: size_t {
+        cycles,
+        instructions,
+        l1d_misses,
+        llc_misses,
+        branch_misses,
+        nbevents
+    };
+    /** Get the name of an event.
+     * @param event Event
+     * @return Constant null-terminated name
+    **/
+    constexpr static char const* get_name(size_t event) noexcept {
+        constexpr char const* names[nbevents] = {"cycles", "instructions", "L1D misses", "LLC misses", "branch misses"};
+        return names[event];
+    }
+    /** Get the identifier of an event, for machine-readable reports.
+     * @param event Event
+     * @return Constant null-terminated identifier
+    **/
+    constexpr static char const* get_key(size_t event) noexcept {
+        constexpr char const* keys[nbevents] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+        return keys[event];
+    }
+private:
+    uint_fast64_t values[nbevents]; // Count of each event
+    bool          valid[nbevents];  // Whether each event could be counted in every segment
+    int           error;            // 'errno' of the first counter that could not be opened, 0 if none
+public:
+    /** Empty counts constructor, every event valid until proven otherwise.
+    **/
+    PerfCounts() noexcept: error{0} {
+        for (size_t i = 0; i < nbevents; ++i) {
+            values[i] = 0;
+            valid[i]  = true;
+        }
+    }
+public:
+    /** Add a count of an event.
+     * @param event Event
+     * @param value Count to add
+    **/
+    void add(size_t event, uint_fast64_t value) noexcept {
+        values[event] += value;
+    }
+    /** Mark an event as not counted.
+     * @param event Event
+     * @param errnum 'errno' of the failure
+    **/
+    void invalidate(size_t event, int errnum) noexcept {
+        valid[event] = false;
+        if (error == 0)
+            error = errnum;
+    }
+    /** Add the counts of another segment.
+     * @param other Counts to merge
+    **/
+    void merge(PerfCounts const& other) noexcept {
+        for (size_t i = 0; i < nbevents; ++i) {
+            values[i] += other.values[i];
+            if (!other.valid[i])
+                invalidate(i, other.error);
+        }
+    }
+public:
+    /** Get the count of an event.
+     * @param event Event
+     * @return Count
+    **/
+    auto get(size_t event) const noexcept {
+        return values[event];
+    }
+    /** Check whether an event was counted.
+     * @param event Event
+     * @return Whether the count is meaningful
+    **/
+    auto is_valid(size_t event) const noexcept {
+        return valid[event];
+    }
+    /** Get the error of the first counter that could not be opened.
+     * @return 'errno' value, 0 if none
+    **/
+    auto get_error() const noexcept {
+        return error;
+    }
+};
+
+/** Hardware performance counters of the calling thread, counting user-space events only.
+**/
+class PerfCounters final: private NonCopyable {
+private:
+    int fds[PerfCounts::nbevents]; // File descriptor of each counter, -1 if it could not be opened
+    int errors[PerfCounts::nbevents]; // 'errno' of each counter that could not be opened
+    uint64_t enabled[PerfCounts::nbevents]; // Time each counter had been enabled at the last 'start' (not cleared by a reset)
+    uint64_t running[PerfCounts::nbevents]; // Time each counter had been running at the last 'start' (not cleared by a reset)
+private:
+    /** Open a counter for the calling thread, disabled.
+     * @param type   Event type
+     * @param config Event configuration
+     * @return File descriptor, -1 on failure (with 'errno' set)
+    **/
+    static int open(uint32_t type, uint64_t config) noexcept {
+        struct ::perf_event_attr attr;
+        ::std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = type;
+        attr.config         = config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1; // Allowed by the default 'perf_event_paranoid' level
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+public:
+    /** Open the counters of the calling thread; counters that cannot be opened are reported as invalid.
+    **/
+    PerfCounters() noexcept {
+        constexpr uint64_t cache_read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        uint32_t const types[PerfCounts::nbevents]   = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+        uint64_t const configs[PerfCounts::nbevents] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_L1D | cache_read_miss, PERF_COUNT_HW_CACHE_LL | cache_read_miss, PERF_COUNT_HW_BRANCH_MISSES};
+        for (size_t i = 0; i < PerfCounts::nbevents; ++i) {
+            fds[i]     = open(types[i], configs[i]);
+            errors[i]  = fds[i] < 0 ? errno : 0;
+            enabled[i] = 0;
+            running[i] = 0;
+        }
+    }
+    /** Close destructor.
+    **/
+    ~PerfCounters() noexcept {
+        for (auto fd: fds) {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    }
+public:
+    /** Reset and start the counters.
+    **/
+    void start() noexcept {
+        for (size_t i = 0; i < PerfCounts::nbevents; ++i) {
+            if (fds[i] < 0)
+                continue;
+            ::ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            uint64_t buf[3]; // Value, time enabled, time running
+            if (likely(::read(fds[i], buf, sizeof(buf)) == sizeof(buf))) {
+                enabled[i] = buf[1];
+                running[i] = buf[2];
+            }
+        }
+        for (auto fd: fds) {
+            if (fd >= 0)
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    /** Stop the counters, and add what they counted since 'start'.
+     * @param counts Counts to add to
+    **/
+    void stop(PerfCounts& counts) noexcept {
+        for (auto fd: fds) {
+            if (fd >= 0)
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (size_t i = 0; i < PerfCounts::nbevents; ++i) {
+            if (fds[i] < 0) {
+                counts.invalidate(i, errors[i]);
+                continue;
+            }
+            uint64_t buf[3]; // Value, time enabled, time running
+            if (unlikely(::read(fds[i], buf, sizeof(buf)) != sizeof(buf))) {
+                counts.invalidate(i, errno);
+                continue;
+            }
+            auto delta_enabled = buf[1] - enabled[i]; // Only the times since 'start' scale this count
+            auto delta_running = buf[2] - running[i];
+            if (delta_running > 0 && delta_running < delta_enabled) // Multiplexed with other counters: extrapolate
+                buf[0] = static_cast<uint64_t>(static_cast<double>(buf[0]) * static_cast<double>(delta_enabled) / static_cast<double>(delta_running));
+            counts.add(i, buf[0]);
+        }
+    }
+};
@@ -0,0 +1,222 @@
+/**
+ * @file   report.hpp
+ * @author Sébastien Rouault <sebastien.rouault@epfl.ch>
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Human-readable or machine-readable (JSON, CSV) report of the run parameters and results.
+**/
+
+#pragma once
+
+// External headers
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+
+/** Report of a run: one section of parameters, then one section per evaluated library.
+ * In the JSON and CSV formats, the human-readable text is discarded and the whole report is printed at the end.
+**/
+class Report final: private NonCopyable {
+public:
+    /** Output format.
+    **/
+    enum class Format {
+        text, // Unicode-framed text, printed as the run goes
+        json, // '{"parameters": {...}, "libraries": [{...}, ...]}'
+        csv   // 'library,key,value' rows, with an empty library index for the parameters
+    };
+private:
+    /** Recorded value.
+    **/
+    struct Entry {
+        ::std::string key;  // Key, unique in its section
+        ::std::string json; // Value, rendered in JSON
+        ::std::string csv;  // Value, rendered in a CSV field
+    };
+    using Section = ::std::vector<Entry>;
+private:
+    Format                 format;   // Output format
+    ::std::ostream         human;    // Human-readable text, discarded unless in text format
+    ::std::vector<Section> sections; // Parameters, then each library
+private:
+    /** Render a number.
+     * @param value Number to render
+     * @return Rendered number, "null" if not finite
+    **/
+    template<class Type> static ::std::string number(Type value) {
+        if constexpr (::std::is_floating_point_v<Type>) {
+            if (!::std::isfinite(value))
+                return "null";
+        }
+        ::std::ostringstream res;
+        if constexpr (::std::is_floating_point_v<Type>)
+            res.precision(::std::numeric_limits<Type>::digits10);
+        res << value;
+        return res.str();
+    }
+    /** Render a string in JSON.
+     * @param value String to render
+     * @return Quoted and escaped string
+    **/
+    static ::std::string json_string(::std::string const& value) {
+        ::std::string res{"\""};
+        for (auto c: value) {
+            if (c == '"' || c == '\\') {
+                res += '\\';
+                res += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                ::std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned int>(c));
+                res += buf;
+            } else {
+                res += c;
+            }
+        }
+        return res + '"';
+    }
+    /** Render a string in a CSV field.
+     * @param value String to render
+     * @return String, quoted if it contains a separator, a quote or a line break
+    **/
+    static ::std::string csv_string(::std::string const& value) {
+        if (value.find_first_of(",\"\r\n") == ::std::string::npos)
+            return value;
+        ::std::string res{"\""};
+        for (auto c: value) {
+            if (c == '"')
+                res += '"';
+            res += c;
+        }
+        return res + '"';
+    }
+    /** Record a rendered value in the current section.
+     * @param key  Key of the value
+     * @param json Value, rendered in JSON
+     * @param csv  Value, rendered in a CSV field
+    **/
+    void record(::std::string const& key, ::std::string json, ::std::string csv) {
+        if (format != Format::text)
+            sections.back().push_back(Entry{key, ::std::move(json), ::std::move(csv)});
+    }
+public:
+    /** Format constructor, opening the parameter section.
+     * @param format Output format
+    **/
+    Report(Format format): format{format}, human{format == Format::text ? ::std::cout.rdbuf() : nullptr}, sections(1) {}
+public:
+    /** Get the stream of the human-readable text.
+     * @return Output stream, discarding everything unless in text format
+    **/
+    ::std::ostream& text() noexcept {
+        return human;
+    }
+    /** Open the section of the next evaluated library; subsequent values are recorded there.
+    **/
+    void open_library() {
+        if (format != Format::text)
+            sections.emplace_back();
+    }
+    /** Record a string.
+     * @param key   Key of the value
+     * @param value String to record
+    **/
+    void add(::std::string const& key, ::std::string const& value) {
+        record(key, json_string(value), csv_string(value));
+    }
+    void add(::std::string const& key, char const* value) {
+        add(key, ::std::string{value});
+    }
+    /** Record a boolean.
+     * @param key   Key of the value
+     * @param value Boolean to record
+    **/
+    void add(::std::string const& key, bool value) {
+        record(key, value ? "true" : "false", value ? "true" : "false");
+    }
+    /** Record a missing value.
+     * @param key Key of the value
+    **/
+    void add(::std::string const& key, ::std::nullptr_t) {
+        record(key, "null", "");
+    }
+    /** Record a number.
+     * @param key   Key of the value
+     * @param value Number to record
+    **/
+    template<class Type, class = ::std::enable_if_t<::std::is_arithmetic_v<Type>>> void add(::std::string const& key, Type value) {
+        auto res = number(value);
+        record(key, res, res == "null" ? "" : res);
+    }
+    /** Record a list of numbers, as a JSON array or as space-separated numbers in CSV.
+     * @param key    Key of the value
+     * @param values Numbers to record
+    **/
+    template<class Type> void add(::std::string const& key, ::std::vector<Type> const& values) {
+        ::std::string json{"["};
+        ::std::string csv;
+        for (auto&& value: values) {
+            auto res = number(value);
+            if (!csv.empty()) {
+                json += ", ";
+                csv  += ' ';
+            }
+            json += res;
+            csv  += res;
+        }
+        record(key, json + ']', csv);
+    }
+    /** Print the whole report, unless in text format (already printed).
+     * @param out Output stream
+    **/
+    void print(::std::ostream& out) const {
+        if (format == Format::json) {
+            auto print_section = [&](Section const& section, char const* indent) {
+                out << "{";
+                auto first = true;
+                for (auto&& entry: section) {
+                    out << (first ? "\n" : ",\n") << indent << "  " << json_string(entry.key) << ": " << entry.json;
+                    first = false;
+                }
+                out << "\n" << indent << "}";
+            };
+            out << "{\n  \"parameters\": ";
+            print_section(sections.front(), "  ");
+            out << ",\n  \"libraries\": [";
+            for (size_t i = 1; i < sections.size(); ++i) {
+                out << (i > 1 ? ",\n    " : "\n    ");
+                print_section(sections[i], "    ");
+            }
+            out << (sections.size() > 1 ? "\n  ]\n}" : "]\n}") << ::std::endl;
+        } else if (format == Format::csv) {
+            out << "library,key,value\n";
+            for (size_t i = 0; i < sections.size(); ++i) {
+                for (auto&& entry: sections[i])
+                    out << (i > 0 ? ::std::to_string(i - 1) : "") << ',' << csv_string(entry.key) << ',' << entry.csv << '\n';
+            }
+            out.flush();
+        }
+    }
+};
@@ -0,0 +1,218 @@
+/**
+ * @file   topology.hpp
+ * @author Sébastien Rouault <sebastien.rouault@epfl.ch>
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * CPU topology discovery (from the Linux sysfs) and thread placement helpers.
+**/
+
+#pragma once
+
+// External headers
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+extern "C" {
+#include <pthread.h>
+#include <sched.h>
+}
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Placement, Any, "unable to restrict a thread to its CPU(s)");
+
+}
+// -------------------------------------------------------------------------- //
+
+namespace Topology {
+
+/** CPU identifier class.
+**/
+using Cpu = unsigned int;
+
+/** Read the first integer of a (sysfs) file.
+ * @param path Path of the file to read
+ * @return Read integer, -1 if the file is missing or malformed
+**/
+static long read_value(::std::string const& path) {
+    ::std::ifstream file{path};
+    long res;
+    if (!(file >> res))
+        return -1;
+    return res;
+}
+
+/** Parse a list of CPUs, in the sysfs format (e.g. "0-3,8,10-11").
+ * @param list Null-terminated list to parse
+ * @return CPUs in order of appearance, empty if the list is malformed
+**/
+static ::std::vector<Cpu> parse_list(char const* list) {
+    ::std::vector<Cpu> res;
+    while (*list != '\0' && *list != '\n') {
+        char* end;
+        auto first = ::std::strtoul(list, &end, 10);
+        if (end == list)
+            return {};
+        auto last = first;
+        if (*end == '-') {
+            list = end + 1;
+            last = ::std::strtoul(list, &end, 10);
+            if (end == list || last < first)
+                return {};
+        }
+        for (auto cpu = first; cpu <= last; ++cpu)
+            res.push_back(static_cast<Cpu>(cpu));
+        if (*end == ',')
+            ++end;
+        else if (*end != '\0' && *end != '\n')
+            return {};
+        list = end;
+    }
+    return res;
+}
+
+/** Format a list of CPUs, in the sysfs format.
+ * @param cpus CPUs to format
+ * @return Formatted list, where runs of consecutive CPUs are ranges
+**/
+static ::std::string format_list(::std::vector<Cpu> const& cpus) {
+    ::std::string res;
+    for (size_t i = 0; i < cpus.size();) {
+        auto j = i + 1;
+        while (j < cpus.size() && cpus[j] == cpus[j - 1] + 1)
+            ++j;
+        if (!res.empty())
+            res += ',';
+        res += ::std::to_string(cpus[i]);
+        if (j - i > 1)
+            res += '-' + ::std::to_string(cpus[j - 1]);
+        i = j;
+    }
+    return res;
+}
+
+/** Get the CPUs the process may run on.
+ * @return Allowed CPUs, in increasing order
+**/
+static ::std::vector<Cpu> allowed() {
+    ::std::vector<Cpu> res;
+    ::cpu_set_t set;
+    if (unlikely(::sched_getaffinity(0, sizeof(set), &set) != 0))
+        return res;
+    for (Cpu cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set))
+            res.push_back(cpu);
+    }
+    return res;
+}
+
+/** Order the allowed CPUs so that consecutive workers share as much as possible:
+ * the hardware threads of a core first, then the cores of a package, then the packages.
+ * @return Allowed CPUs, in placement order
+**/
+static ::std::vector<Cpu> compact() {
+    ::std::vector<::std::tuple<long, long, Cpu>> keys; // Package, core, CPU
+    for (auto cpu: allowed()) {
+        auto base = "/sys/devices/system/cpu/cpu" + ::std::to_string(cpu) + "/topology/";
+        keys.emplace_back(read_value(base + "physical_package_id"), read_value(base + "core_id"), cpu);
+    }
+    ::std::sort(keys.begin(), keys.end());
+    ::std::vector<Cpu> res;
+    for (auto const& key: keys)
+        res.push_back(::std::get<2>(key));
+    return res;
+}
+
+/** Order the allowed CPUs so that consecutive workers share as little as possible:
+ * one core per package in turn, and the other hardware threads of the cores once every core is used.
+ * @return Allowed CPUs, in placement order
+**/
+static ::std::vector<Cpu> scatter() {
+    auto order = compact();
+    ::std::vector<::std::tuple<size_t, size_t, long, Cpu>> keys; // Rank in its core, rank of its core in its package, package, CPU
+    long   package    = -2;
+    long   core       = -2;
+    size_t core_rank  = 0;
+    size_t cpu_rank   = 0;
+    for (auto cpu: order) { // Consecutive in 'compact' order: hardware threads of a core, cores of a package
+        auto base = "/sys/devices/system/cpu/cpu" + ::std::to_string(cpu) + "/topology/";
+        auto cpu_package = read_value(base + "physical_package_id");
+        auto cpu_core    = read_value(base + "core_id");
+        if (cpu_package != package) {
+            package   = cpu_package;
+            core      = cpu_core;
+            core_rank = 0;
+            cpu_rank  = 0;
+        } else if (cpu_core != core || cpu_core < 0) {
+            core = cpu_core;
+            ++core_rank;
+            cpu_rank = 0;
+        } else {
+            ++cpu_rank;
+        }
+        keys.emplace_back(cpu_rank, core_rank, package, cpu);
+    }
+    ::std::sort(keys.begin(), keys.end());
+    ::std::vector<Cpu> res;
+    for (auto const& key: keys)
+        res.push_back(::std::get<3>(key));
+    return res;
+}
+
+/** Get the allowed CPUs of a NUMA node.
+ * @param node NUMA node
+ * @return Allowed CPUs of the node, in increasing order (empty if the node does not exist)
+**/
+static ::std::vector<Cpu> node(long node) {
+    ::std::ifstream file{"/sys/devices/system/node/node" + ::std::to_string(node) + "/cpulist"};
+    ::std::string list;
+    if (!::std::getline(file, list))
+        return {};
+    auto cpus = parse_list(list.c_str());
+    auto permitted = allowed();
+    ::std::vector<Cpu> res;
+    for (auto cpu: cpus) {
+        if (::std::binary_search(permitted.begin(), permitted.end(), cpu))
+            res.push_back(cpu);
+    }
+    return res;
+}
+
+/** Restrict the calling thread to the given CPUs.
+ * @param cpus Non-empty set of CPUs
+ * @return Whether the operation is a success
+**/
+static bool pin(::std::vector<Cpu> const& cpus) {
+    ::cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu: cpus) {
+        if (unlikely(cpu >= CPU_SETSIZE))
+            return false;
+        CPU_SET(cpu, &set);
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+}
+
+}
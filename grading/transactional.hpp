@@ -28,6 +28,11 @@ extern "C" {
 #include <dlfcn.h>
 #include <limits.h>
 }
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 // Internal headers
 namespace STM {
@@ -80,6 +85,15 @@ private:
     using FnWrite   = decltype(&STM::tm_write);
     using FnAlloc   = decltype(&STM::tm_alloc);
     using FnFree    = decltype(&STM::tm_free);
+    using FnCreateDurable = decltype(&STM::tm_create_durable);
+    using FnStats   = decltype(&STM::tm_stats);
+    using FnReadv   = decltype(&STM::tm_readv);
+    using FnWritev  = decltype(&STM::tm_writev);
+    using FnAdd     = decltype(&STM::tm_add);
+    using FnBeginNested    = decltype(&STM::tm_begin_nested);
+    using FnEndNested      = decltype(&STM::tm_end_nested);
+    using FnRollbackNested = decltype(&STM::tm_rollback_nested);
+    using FnBeginExt       = decltype(&STM::tm_begin_ext);
 private:
     void*     module;     // Module opaque handler
     FnCreate  tm_create;  // Module's initialization function
@@ -93,6 +107,15 @@ private:
     FnWrite   tm_write;   // Module's shared memory write function
     FnAlloc   tm_alloc;   // Module's shared memory allocation function
     FnFree    tm_free;    // Module's shared memory freeing function
+    FnCreateDurable tm_create_durable; // Module's durable initialization function (optional, 'nullptr' if not exported)
+    FnStats   tm_stats;   // Module's statistics query function (optional, 'nullptr' if not exported)
+    FnReadv   tm_readv;   // Module's batched shared memory read function (optional, 'nullptr' if not exported)
+    FnWritev  tm_writev;  // Module's batched shared memory write function (optional, 'nullptr' if not exported)
+    FnAdd     tm_add;     // Module's commutative shared word addition function (optional, 'nullptr' if not exported)
+    FnBeginNested    tm_begin_nested;    // Module's nested scope begin function (optional, 'nullptr' if not exported)
+    FnEndNested      tm_end_nested;      // Module's nested scope end function (optional, 'nullptr' if not exported)
+    FnRollbackNested tm_rollback_nested; // Module's nested scope rollback function (optional, 'nullptr' if not exported)
+    FnBeginExt       tm_begin_ext;       // Module's transaction begin function with footprint hints (optional, 'nullptr' if not exported)
 private:
     /** Solve a symbol from its name, and bind it to the given function.
      * @param name Name of the symbol to resolve
@@ -107,6 +130,14 @@ private:
     template<class Signature> void solve(char const* name, Signature& func) const {
         func = solve<Signature>(name);
     }
+    /** Solve an optional symbol from its name, and bind it to the given function ('nullptr' if not found).
+     * @param name Name of the symbol to resolve
+     * @param func Target function to bind
+    **/
+    template<class Signature> void solve_optional(char const* name, Signature& func) const {
+        auto res = ::dlsym(module, name);
+        func = res ? *reinterpret_cast<Signature*>(&res) : nullptr;
+    }
 public:
     /** Loader constructor.
      * @param path  Path to the library to load
@@ -133,12 +164,32 @@ public:
             solve("tm_alloc", tm_alloc);
             solve("tm_free", tm_free);
         }
+        { // Bind module's optional 'tm_*' symbols
+            solve_optional("tm_create_durable", tm_create_durable);
+            solve_optional("tm_stats", tm_stats);
+            solve_optional("tm_readv", tm_readv);
+            solve_optional("tm_writev", tm_writev);
+            solve_optional("tm_add", tm_add);
+            solve_optional("tm_begin_nested", tm_begin_nested);
+            solve_optional("tm_end_nested", tm_end_nested);
+            solve_optional("tm_rollback_nested", tm_rollback_nested);
+            if (!tm_begin_nested || !tm_end_nested || !tm_rollback_nested) // Nesting needs all three
+                tm_begin_nested = nullptr;
+            solve_optional("tm_begin_ext", tm_begin_ext);
+        }
     }
     /** Unloader destructor.
     **/
     ~TransactionalLibrary() noexcept {
         ::dlclose(module); // Close loaded module
     }
+public:
+    /** [thread-safe] Check whether the library supports durable shared memory regions.
+     * @return Whether 'tm_create_durable' is exported
+    **/
+    bool has_durable() const noexcept {
+        return tm_create_durable != nullptr;
+    }
 };
 
 /** One shared memory region management class.
@@ -157,6 +208,15 @@ public:
     /** Transaction class alias.
     **/
     using TX = STM::tx_t;
+    /** Statistics class alias.
+    **/
+    using Stats = struct STM::tm_stats;
+    /** Batched access class alias.
+    **/
+    using Access = struct STM::tm_access;
+    /** Footprint hints class alias.
+    **/
+    using Hints = struct STM::tm_hints;
 private:
     TransactionalLibrary const& tl; // Bound transactional library
     Shared shared;     // Handle of the shared memory region used
@@ -168,12 +228,15 @@ public:
      * @param library Transactional library to use
      * @param align   Shared memory region required alignment
      * @param size    Size of the shared memory region to allocate
+     * @param logpath Path to the log file making the region durable ('nullptr' for a non-durable region)
     **/
-    TransactionalMemory(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, start_size{size}, alignment{align} {
+    TransactionalMemory(TransactionalLibrary const& library, size_t align, size_t size, char const* logpath = nullptr): tl{library}, start_size{size}, alignment{align} {
         if (unlikely(assert_mode && (!is_power_of_two(align) || size % align != 0)))
             throw Exception::TransactionAlign{};
+        if (unlikely(logpath && !tl.has_durable()))
+            throw Exception::ModuleSymbol{};
         bounded_run(max_side_time, [&]() {
-            shared = tl.tm_create(size, align);
+            shared = logpath ? tl.tm_create_durable(size, align, logpath) : tl.tm_create(size, align);
             if (unlikely(shared == STM::invalid_shared))
                 throw Exception::TransactionCreate{};
             start_addr = tl.tm_start(shared);
@@ -205,6 +268,13 @@ public:
     auto get_align() const noexcept {
         return alignment;
     }
+    /** [thread-safe] Get the statistics of the shared memory region since its creation, if the library reports any.
+     * @param stats Statistics to fill
+     * @return Whether the library filled the statistics
+    **/
+    bool get_stats(Stats& stats) const noexcept {
+        return tl.tm_stats && tl.tm_stats(shared, &stats);
+    }
 public:
     /** [thread-safe] Begin a new transaction on the shared memory region.
      * @param ro Whether the transaction is read-only
@@ -213,6 +283,14 @@ public:
     auto begin(bool ro) const noexcept {
         return tl.tm_begin(shared, ro);
     }
+    /** [thread-safe] Begin a new transaction on the shared memory region, given its expected footprint.
+     * @param ro    Whether the transaction is read-only
+     * @param hints Expected footprint of the transaction (ignored if the library takes no hints)
+     * @return Opaque transaction ID, 'STM::invalid_tx' on failure
+    **/
+    auto begin(bool ro, Hints const& hints) const noexcept {
+        return tl.tm_begin_ext ? tl.tm_begin_ext(shared, ro, &hints) : tl.tm_begin(shared, ro);
+    }
     /** [thread-safe] End the given transaction.
      * @param tx Opaque transaction ID
      * @return Whether the whole transaction is a success
@@ -240,6 +318,76 @@ public:
     auto write(TX tx, void const* source, size_t size, void* target) const noexcept {
         return tl.tm_write(shared, tx, source, size, target);
     }
+    /** [thread-safe] Batched read operation in the given transaction, one read per access if the library has no batched read.
+     * @param tx       Transaction to use
+     * @param accesses Accesses to perform, sources in the shared region and targets in a private region
+     * @param count    Number of accesses
+     * @return Whether the whole transaction can continue
+    **/
+    bool readv(TX tx, Access const* accesses, size_t count) const noexcept {
+        if (tl.tm_readv)
+            return tl.tm_readv(shared, tx, accesses, count);
+        for (size_t i = 0; i < count; ++i) {
+            if (unlikely(!tl.tm_read(shared, tx, accesses[i].source, accesses[i].size, accesses[i].target)))
+                return false;
+        }
+        return true;
+    }
+    /** [thread-safe] Batched write operation in the given transaction, one write per access if the library has no batched write.
+     * @param tx       Transaction to use
+     * @param accesses Accesses to perform, sources in a private region and targets in the shared region
+     * @param count    Number of accesses
+     * @return Whether the whole transaction can continue
+    **/
+    bool writev(TX tx, Access const* accesses, size_t count) const noexcept {
+        if (tl.tm_writev)
+            return tl.tm_writev(shared, tx, accesses, count);
+        for (size_t i = 0; i < count; ++i) {
+            if (unlikely(!tl.tm_write(shared, tx, accesses[i].source, accesses[i].size, accesses[i].target)))
+                return false;
+        }
+        return true;
+    }
+    /** [thread-safe] Commutative addition on a shared word in the given transaction, a read then a write if the library has no addition.
+     * @param tx     Transaction to use
+     * @param target Target word address
+     * @param delta  Value to add
+     * @param floor  Lowest value the word may take
+     * @return Addition status
+    **/
+    STM::Add add(TX tx, intptr_t* target, intptr_t delta, intptr_t floor) const noexcept {
+        if (tl.tm_add)
+            return tl.tm_add(shared, tx, target, delta, floor);
+        intptr_t value;
+        if (unlikely(!tl.tm_read(shared, tx, target, sizeof(value), &value)))
+            return STM::Add::abort;
+        if (__builtin_add_overflow(value, delta, &value) || value < floor)
+            return STM::Add::bound;
+        if (unlikely(!tl.tm_write(shared, tx, &value, sizeof(value), target)))
+            return STM::Add::abort;
+        return STM::Add::success;
+    }
+    /** [thread-safe] Open a nested scope in the given transaction.
+     * @param tx Transaction to use
+     * @return Whether the scope was opened (otherwise, e.g. if the library has no nesting, the scope is flattened into the transaction)
+    **/
+    bool begin_nested(TX tx) const noexcept {
+        return tl.tm_begin_nested && tl.tm_begin_nested(shared, tx);
+    }
+    /** [thread-safe] Close the innermost nested scope of the given transaction, merging it into its parent.
+     * @param tx Transaction to use
+     * @return Whether the scope can close (otherwise it must be rolled back)
+    **/
+    auto end_nested(TX tx) const noexcept {
+        return tl.tm_end_nested(shared, tx);
+    }
+    /** [thread-safe] Undo and close the innermost nested scope of the given transaction.
+     * @param tx Transaction to use
+     * @return Whether the transaction can continue (otherwise the whole transaction has been aborted)
+    **/
+    auto rollback_nested(TX tx) const noexcept {
+        return tl.tm_rollback_nested(shared, tx);
+    }
     /** [thread-safe] Memory allocation operation in the given transaction, throw if no memory available.
      * @param tx     Transaction to use
      * @param size   Size to allocate
@@ -287,6 +435,15 @@ public:
         if (unlikely(tx == STM::invalid_tx))
             throw Exception::TransactionBegin{};
     }
+    /** Begin constructor, with footprint hints.
+     * @param tm    Transactional memory to bind
+     * @param ro    Whether the transaction is read-only
+     * @param hints Expected footprint of the transaction
+    **/
+    Transaction(TransactionalMemory const& tm, Mode ro, TransactionalMemory::Hints const& hints): tm{tm}, tx{tm.begin(static_cast<bool>(ro), hints)}, aborted{false}, is_ro{static_cast<bool>(ro)} {
+        if (unlikely(tx == STM::invalid_tx))
+            throw Exception::TransactionBegin{};
+    }
     /** End destructor.
     **/
     ~Transaction() noexcept(false) {
@@ -327,6 +484,72 @@ public:
             throw Exception::TransactionRetry{};
         }
     }
+    /** [thread-safe] Batched read operation in the bound transaction, sources in the shared region and targets in a private region.
+     * @param accesses Accesses to perform
+     * @param count    Number of accesses
+    **/
+    void readv(TransactionalMemory::Access const* accesses, size_t count) {
+        if (unlikely(!tm.readv(tx, accesses, count))) {
+            aborted = true;
+            throw Exception::TransactionRetry{};
+        }
+    }
+    /** [thread-safe] Batched write operation in the bound transaction, sources in a private region and targets in the shared region.
+     * @param accesses Accesses to perform
+     * @param count    Number of accesses
+    **/
+    void writev(TransactionalMemory::Access const* accesses, size_t count) {
+        if (unlikely(assert_mode && is_ro))
+            throw Exception::TransactionReadOnly{};
+        if (unlikely(!tm.writev(tx, accesses, count))) {
+            aborted = true;
+            throw Exception::TransactionRetry{};
+        }
+    }
+    /** [thread-safe] Commutative addition on a shared word in the bound transaction.
+     * @param target Target word address
+     * @param delta  Value to add
+     * @param floor  Lowest value the word may take
+     * @return Whether the delta was applied (i.e. the result did not go below the floor)
+    **/
+    bool add(intptr_t* target, intptr_t delta, intptr_t floor) {
+        if (unlikely(assert_mode && is_ro))
+            throw Exception::TransactionReadOnly{};
+        switch (tm.add(tx, target, delta, floor)) {
+        case STM::Add::success:
+            return true;
+        case STM::Add::bound:
+            return false;
+        default: // STM::Add::abort
+            aborted = true;
+            throw Exception::TransactionRetry{};
+        }
+    }
+    /** [thread-safe] Open a nested scope in the bound transaction.
+     * @return Whether the scope was opened (otherwise the scope is flattened into the transaction)
+    **/
+    bool begin_nested() noexcept {
+        return tm.begin_nested(tx);
+    }
+    /** [thread-safe] Close the innermost nested scope of the bound transaction, throw if the scope must be rolled back.
+    **/
+    void end_nested() {
+        if (unlikely(!tm.end_nested(tx))) {
+            aborted = true;
+            throw Exception::TransactionRetry{};
+        }
+    }
+    /** [thread-safe] Undo and close the innermost nested scope of the bound transaction, after one of its operations failed.
+     * @return Whether the transaction can continue (otherwise it stays aborted, and must be retried as a whole)
+    **/
+    bool rollback_nested() noexcept {
+        if (unlikely(!tm.rollback_nested(tx))) {
+            aborted = true;
+            return false;
+        }
+        aborted = false;
+        return true;
+    }
     /** [thread-safe] Memory allocation operation in the bound transaction, throw if no memory available.
      * @param size Size to allocate
      * @return Target start address
@@ -406,6 +629,15 @@ public:
     void operator=(Type const& source) const {
         return write(source);
     }
+    /** Commutative addition operation, only for word-sized integers.
+     * @param delta Value to add
+     * @param floor Lowest value the content may take
+     * @return Whether the delta was applied (i.e. the result did not go below the floor)
+    **/
+    bool add(Type delta, Type floor = ::std::numeric_limits<Type>::min()) const {
+        static_assert(::std::is_same<Type, intptr_t>::value, "Commutative addition is only available on 'intptr_t'");
+        return tx.add(address, delta, floor);
+    }
 public:
     /** Address of the first byte after the entry.
      * @return First byte after the entry
@@ -521,7 +753,29 @@ public:
      * @param source Private content to write at the shared address
     **/
     void write(size_t index, Type const& source) const {
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(&source, sizeof(Type), address + index);
+    }
+    /** Range read operation, one batched read of every cell.
+     * @param index  Index of the first cell to read
+     * @param count  Number of cells to read
+     * @param target Private array receiving a copy of the cells
+    **/
+    void read(size_t index, size_t count, Type* target) const {
+        ::std::vector<TransactionalMemory::Access> accesses(count);
+        for (size_t i = 0; i < count; ++i)
+            accesses[i] = {address + index + i, sizeof(Type), target + i};
+        tx.readv(accesses.data(), count);
+    }
+    /** Range write operation, one batched write of every cell.
+     * @param index  Index of the first cell to write
+     * @param count  Number of cells to write
+     * @param source Private array of the contents to write
+    **/
+    void write(size_t index, size_t count, Type const* source) const {
+        ::std::vector<TransactionalMemory::Access> accesses(count);
+        for (size_t i = 0; i < count; ++i)
+            accesses[i] = {source + i, sizeof(Type), address + index + i};
+        tx.writev(accesses.data(), count);
     }
 public:
     /** Reference a cell.
@@ -580,7 +834,7 @@ public:
     void write(size_t index, Type const& source) const {
         if (unlikely(assert_mode && index >= n))
             throw Exception::SharedOverflow{};
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(&source, sizeof(Type), address + index);
     }
 public:
     /** Reference a cell.
@@ -602,19 +856,175 @@ public:
 
 // -------------------------------------------------------------------------- //
 
-/** Repeat a given transaction until it commits.
- * @param tm   Transactional memory
- * @param mode Transactional mode
- * @param func Transaction closure (Transaction& -> ...)
+/** Attempt accounting of the transactions repeated by 'transactional', selected per thread.
+**/
+class alignas(64) Attempts final {
+public:
+    constexpr static size_t nbbuckets = 16; // Number of retry counts in the distribution, the last one gathering the larger counts
+    /** Selection of the accounting of the calling thread, for the lifetime of the instance.
+    **/
+    class Scope final: private NonCopyable {
+    private:
+        Attempts* previous; // Accounting selected before
+    public:
+        /** Selection constructor.
+         * @param attempts Accounting to select
+        **/
+        Scope(Attempts& attempts) noexcept: previous{current} {
+            current = &attempts;
+        }
+        /** Restore destructor.
+        **/
+        ~Scope() noexcept {
+            current = previous;
+        }
+    };
+    /** Accounting of a single attempt, committed if its scope is left without an exception.
+    **/
+    class Attempt final: private NonCopyable {
+    private:
+        Attempts* attempts;   // Accounting of the calling thread, 'nullptr' for none
+        size_t    nbretries;  // Number of retries before this attempt
+        int       exceptions; // Number of uncaught exceptions when the attempt began
+    public:
+        /** Begin constructor.
+         * @param nbretries Number of retries before this attempt
+        **/
+        Attempt(size_t nbretries) noexcept: attempts{current}, nbretries{nbretries}, exceptions{::std::uncaught_exceptions()} {
+            if (attempts)
+                ++attempts->attempts;
+        }
+        /** End destructor, declared before the transaction so that it runs after its commit.
+        **/
+        ~Attempt() noexcept {
+            if (attempts && ::std::uncaught_exceptions() == exceptions) {
+                ++attempts->commits;
+                ++attempts->buckets[::std::min(nbretries, nbbuckets - 1)];
+            }
+        }
+    };
+private:
+    inline static thread_local Attempts* current = nullptr; // Accounting of the calling thread, 'nullptr' for none
+    uint_fast64_t attempts;           // Number of begun attempts
+    uint_fast64_t commits;            // Number of committed attempts
+    uint_fast64_t retries;            // Number of aborted attempts that were retried
+    uint_fast64_t buckets[nbbuckets]; // Number of committed transactions per number of retries
+public:
+    /** Empty accounting constructor.
+    **/
+    Attempts() noexcept {
+        reset();
+    }
+public:
+    /** [thread-safe] Account a retry in the accounting of the calling thread, if any.
+    **/
+    static void retry() noexcept {
+        if (current)
+            ++current->retries;
+    }
+    /** Add the counts of another accounting.
+     * @param other Accounting to merge
+    **/
+    void merge(Attempts const& other) noexcept {
+        attempts += other.attempts;
+        commits  += other.commits;
+        retries  += other.retries;
+        for (size_t i = 0; i < nbbuckets; ++i)
+            buckets[i] += other.buckets[i];
+    }
+    /** Reset every count.
+    **/
+    void reset() noexcept {
+        attempts = 0;
+        commits  = 0;
+        retries  = 0;
+        for (auto&& bucket: buckets)
+            bucket = 0;
+    }
+public:
+    /** Get the number of begun attempts.
+     * @return Number of attempts
+    **/
+    auto get_attempts() const noexcept {
+        return attempts;
+    }
+    /** Get the number of committed attempts.
+     * @return Number of commits
+    **/
+    auto get_commits() const noexcept {
+        return commits;
+    }
+    /** Get the number of retried attempts.
+     * @return Number of retries
+    **/
+    auto get_retries() const noexcept {
+        return retries;
+    }
+    /** Get the number of committed transactions that needed the given number of retries.
+     * @param nbretries Number of retries (the last bucket also counts the larger numbers)
+     * @return Number of transactions
+    **/
+    auto get_bucket(size_t nbretries) const noexcept {
+        return buckets[nbretries];
+    }
+};
+
+/** Repeat a given transaction until it commits, accounting its attempts in the accounting selected by the calling thread (if any).
+ * @param tm    Transactional memory
+ * @param mode  Transactional mode
+ * @param hints Expected footprint of the transaction (optional)
+ * @param func  Transaction closure (Transaction& -> ...)
  * @return Returned value (or void) when the transaction committed
 **/
 template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, Func&& func) {
-    do {
+    for (size_t nbretries = 0;; ++nbretries) {
         try {
+            Attempts::Attempt attempt{nbretries};
             Transaction tx{tm, mode};
             return func(tx);
         } catch (Exception::TransactionRetry const&) {
-            continue;
+            Attempts::retry();
+        }
+    }
+}
+template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, TransactionalMemory::Hints const& hints, Func&& func) {
+    for (size_t nbretries = 0;; ++nbretries) {
+        try {
+            Attempts::Attempt attempt{nbretries};
+            Transaction tx{tm, mode, hints};
+            return func(tx);
+        } catch (Exception::TransactionRetry const&) {
+            Attempts::retry();
+        }
+    }
+}
+
+/** Run a closed nested scope in the given transaction, retrying only the scope when one of its operations fails.
+ * If the library does not support nesting, the scope is flattened and a failure retries the whole transaction.
+ * @param tx   Enclosing transaction
+ * @param func Scope closure (Transaction& -> ...)
+ * @return Returned value (or void) when the scope closed
+**/
+template<class Func> static auto nested(Transaction& tx, Func&& func) {
+    do {
+        if (!tx.begin_nested())
+            return func(tx);
+        try {
+            if constexpr (::std::is_void<decltype(func(tx))>::value) {
+                func(tx);
+                tx.end_nested();
+                return;
+            } else {
+                auto res = func(tx);
+                tx.end_nested();
+                return res;
+            }
+        } catch (Exception::TransactionRetry const&) {
+            if (!tx.rollback_nested())
+                throw;
+        } catch (...) { // Undo the scope, so that the enclosing transaction never commits it half-done
+            tx.rollback_nested();
+            throw;
         }
     } while (true);
 }
@@ -24,8 +24,18 @@
 #pragma once
 
 // External headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <optional>
 #include <random>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 // Internal headers
 #include "common.hpp"
@@ -40,12 +50,193 @@ using Uid = uint_fast32_t;
 **/
 using Seed = uint_fast32_t;
 
+/** Distribution of the accessed items among n items, uniform, Zipfian or hot-set.
+**/
+class AccessPattern final {
+public:
+    /** Kind of distribution.
+    **/
+    enum class Kind {
+        uniform, // Every item equally likely
+        zipf,    // Item of rank k (from 1) with a probability proportional to 1/k^theta
+        hotset   // A fraction of the items (the first ones) gets a fixed share of the accesses
+    };
+    /** Sampler of the distribution over a given number of items, precomputed so that each sample costs O(1).
+     * Zipf samples use rejection-inversion (W. Hörmann and G. Derflinger, 1996), whose setup only depends on the
+     * number of items through a closed form, so that a sampler can be rebuilt cheaply when the number of items changes.
+    **/
+    class Sampler final {
+    private:
+        Kind   kind;     // Kind of distribution
+        double theta;    // Skew (Zipf only)
+        double hot_probability; // Probability of accessing a hot item (hot-set only)
+        size_t n;        // Number of items
+        size_t nbhot;    // Number of hot items (hot-set only)
+        double hx1;      // H(1.5) - 1 (Zipf only)
+        double hn;       // H(n + 0.5) (Zipf only)
+        double shortcut; // Threshold under which a candidate is accepted without computing H (Zipf only)
+    private:
+        /** Compute log(1 + x) / x, stable around 0.
+        **/
+        static double helper1(double x) noexcept {
+            return ::std::fabs(x) > 1e-8 ? ::std::log1p(x) / x : 1. - x * (0.5 - x * (1. / 3. - 0.25 * x));
+        }
+        /** Compute (exp(x) - 1) / x, stable around 0.
+        **/
+        static double helper2(double x) noexcept {
+            return ::std::fabs(x) > 1e-8 ? ::std::expm1(x) / x : 1. + x * 0.5 * (1. + x / 3. * (1. + 0.25 * x));
+        }
+        /** Unnormalized probability density, h(x) = 1/x^theta.
+        **/
+        double h(double x) const noexcept {
+            return ::std::exp(-theta * ::std::log(x));
+        }
+        /** Integral of 'h', H(x) = (x^(1-theta) - 1) / (1 - theta), or log(x) if theta = 1.
+        **/
+        double hintegral(double x) const noexcept {
+            auto logx = ::std::log(x);
+            return helper2((1. - theta) * logx) * logx;
+        }
+        /** Inverse of 'hintegral'.
+        **/
+        double hinverse(double x) const noexcept {
+            auto t = x * (1. - theta);
+            if (t < -1.) // Numerical safety
+                t = -1.;
+            return ::std::exp(helper1(t) * x);
+        }
+    public:
+        /** Precomputation constructor.
+         * @param pattern Distribution to sample
+         * @param n       Number of items (non-null)
+        **/
+        Sampler(AccessPattern const& pattern, size_t n) noexcept: kind{pattern.kind}, theta{pattern.theta}, hot_probability{pattern.hot_probability}, n{n}, nbhot{n}, hx1{0.}, hn{0.}, shortcut{0.} {
+            if (kind == Kind::hotset) {
+                nbhot = static_cast<size_t>(::std::ceil(pattern.hot_fraction * static_cast<double>(n)));
+                if (nbhot < 1)
+                    nbhot = 1;
+                if (nbhot > n)
+                    nbhot = n;
+            } else if (kind == Kind::zipf) {
+                hx1      = hintegral(1.5) - 1.;
+                hn       = hintegral(static_cast<double>(n) + 0.5);
+                shortcut = 2. - hinverse(hintegral(2.5) - h(2.));
+            }
+        }
+    public:
+        /** Get the number of items.
+         * @return Number of items
+        **/
+        auto get_size() const noexcept {
+            return n;
+        }
+        /** Draw an item.
+         * @param engine Randomness source
+         * @return Index of the item, in [0, n)
+        **/
+        template<class Engine> size_t operator()(Engine& engine) const {
+            switch (kind) {
+            case Kind::zipf:
+                while (true) {
+                    auto u = hn + ::std::uniform_real_distribution<double>{0., 1.}(engine) * (hx1 - hn);
+                    auto x = hinverse(u);
+                    auto k = ::std::floor(x + 0.5);
+                    if (k < 1.)
+                        k = 1.;
+                    else if (k > static_cast<double>(n))
+                        k = static_cast<double>(n);
+                    if (k - x <= shortcut || u >= hintegral(k + 0.5) - h(k))
+                        return static_cast<size_t>(k) - 1;
+                }
+            case Kind::hotset:
+                if (nbhot == n || ::std::bernoulli_distribution{hot_probability}(engine))
+                    return ::std::uniform_int_distribution<size_t>{0, nbhot - 1}(engine);
+                return ::std::uniform_int_distribution<size_t>{nbhot, n - 1}(engine);
+            default:
+                return ::std::uniform_int_distribution<size_t>{0, n - 1}(engine);
+            }
+        }
+    };
+private:
+    Kind   kind;            // Kind of distribution
+    double theta;           // Skew (Zipf only)
+    double hot_fraction;    // Fraction of hot items (hot-set only)
+    double hot_probability; // Probability of accessing a hot item (hot-set only)
+    /** Full constructor.
+    **/
+    AccessPattern(Kind kind, double theta, double hot_fraction, double hot_probability) noexcept: kind{kind}, theta{theta}, hot_fraction{hot_fraction}, hot_probability{hot_probability} {}
+public:
+    /** Uniform distribution constructor.
+    **/
+    AccessPattern() noexcept: AccessPattern{Kind::uniform, 0., 1., 1.} {}
+    /** Build a Zipfian distribution.
+     * @param theta Skew (positive, 0.99 being the usual "heavily skewed" value)
+     * @return Distribution
+    **/
+    static AccessPattern zipf(double theta) noexcept {
+        return AccessPattern{Kind::zipf, theta, 1., 1.};
+    }
+    /** Build a hot-set distribution.
+     * @param fraction    Fraction of the items that are hot, in (0, 1]
+     * @param probability Probability of accessing a hot item, in [0, 1]
+     * @return Distribution
+    **/
+    static AccessPattern hotset(double fraction, double probability) noexcept {
+        return AccessPattern{Kind::hotset, 0., fraction, probability};
+    }
+public:
+    /** Get the kind of distribution.
+     * @return Kind
+    **/
+    auto get_kind() const noexcept {
+        return kind;
+    }
+    /** Get the skew of a Zipfian distribution.
+     * @return Skew
+    **/
+    auto get_theta() const noexcept {
+        return theta;
+    }
+    /** Get the fraction of hot items of a hot-set distribution.
+     * @return Fraction of hot items
+    **/
+    auto get_hot_fraction() const noexcept {
+        return hot_fraction;
+    }
+    /** Get the probability of accessing a hot item of a hot-set distribution.
+     * @return Probability
+    **/
+    auto get_hot_probability() const noexcept {
+        return hot_probability;
+    }
+    /** Build a sampler over the given number of items.
+     * @param n Number of items (non-null)
+     * @return Sampler
+    **/
+    Sampler sampler(size_t n) const noexcept {
+        return Sampler{*this, n};
+    }
+};
+
 /** Workload base class.
 **/
 class Workload {
 protected:
     TransactionalLibrary const& tl;  // Associated transactional library
     TransactionalMemory         tm;  // Built transactional memory to use
+private:
+    ::std::vector<char const*>       txtypes;   // Names of the transaction types whose latency and attempts are recorded
+    ::std::vector<Histogram> mutable running;   // Latencies during the current repetition, per worker then per type
+    ::std::vector<Histogram>         latencies; // Latencies during the finished repetitions, per type
+    ::std::vector<Attempts> mutable  running_attempts; // Attempts during the current repetition, per worker then per type
+    ::std::vector<Attempts>          attempts;  // Attempts during the finished repetitions, per type
+    ::std::vector<uint_fast64_t> mutable running_done; // Transactions completed during the current repetition, per worker
+    ::std::vector<uint_fast64_t>     done;      // Transactions completed during the finished repetitions, per worker
+    Chrono::Tick                     duration;  // Duration of each repetition (in ns), 0 to run a fixed number of transactions per worker instead
+    Chrono::Tick                     origin;    // Start of the current repetition, when time-bounded
+    Chrono::Tick                     deadline;  // End of the current repetition, when time-bounded
+    double                           interval;  // Mean time between the arrivals of the transactions of a worker (in ns), 0 for closed loop
+    ::std::atomic<char const*> mutable failure; // Last error found during 'check_phases', 'nullptr' for none
 public:
     /** Deleted copy constructor/assignment.
     **/
@@ -55,11 +246,201 @@ public:
      * @param library Transactional library to use
      * @param align   Shared memory region required alignment
      * @param size    Size of the shared memory region to allocate
+     * @param logpath Path to the log file making the region durable ('nullptr' for a non-durable region)
     **/
-    Workload(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, tm{tl, align, size} {}
+    Workload(TransactionalLibrary const& library, size_t align, size_t size, char const* logpath = nullptr): tl{library}, tm{tl, align, size, logpath}, duration{0}, origin{0}, deadline{0}, interval{0.}, failure{nullptr} {}
     /** Virtual destructor.
     **/
     virtual ~Workload() {};
+public:
+    /** [thread-safe] Get the statistics of the transactional library on the shared memory region, if it reports any.
+     * @param stats Statistics to fill
+     * @return Whether the library filled the statistics
+    **/
+    bool get_stats(TransactionalMemory::Stats& stats) const noexcept {
+        return tm.get_stats(stats);
+    }
+    /** Merge the latencies and attempts recorded by the workers during the last repetition, once they are all done.
+     * @return Number of transactions the workers completed during the last repetition
+    **/
+    uint_fast64_t collect() noexcept {
+        uint_fast64_t res = 0;
+        for (size_t i = 0; i < running.size(); ++i) {
+            latencies[i % txtypes.size()].merge(running[i]);
+            running[i].reset();
+            attempts[i % txtypes.size()].merge(running_attempts[i]);
+            running_attempts[i].reset();
+        }
+        for (size_t i = 0; i < running_done.size(); ++i) {
+            res += running_done[i];
+            done[i] += running_done[i];
+            running_done[i] = 0;
+        }
+        return res;
+    }
+    /** Bound each repetition by a duration rather than by a number of transactions per worker.
+     * @param ticks Duration of each repetition (in ns), 0 to go back to a fixed number of transactions
+    **/
+    void set_duration(Chrono::Tick ticks) noexcept {
+        duration = ticks;
+    }
+    /** Issue the transactions in open loop, at the given aggregate rate with exponential inter-arrival times,
+     * instead of issuing the next transaction of a worker when its previous one completes. Requires time-bounded repetitions.
+     * @param rate Aggregate rate of all the workers (in TX/s), 0 to go back to closed loop
+    **/
+    void set_rate(double rate) noexcept {
+        interval = rate > 0. ? static_cast<double>(done.size()) * 1000000000. / rate : 0.;
+    }
+    /** Set the shared origin and deadline of the next repetition (if time-bounded), before the workers are notified.
+    **/
+    void prepare() noexcept {
+        if (duration > 0) {
+            origin   = Chrono::get_time();
+            deadline = origin + duration;
+        }
+    }
+    /** Get the number of transaction types whose latency is recorded.
+     * @return Number of transaction types
+    **/
+    auto get_nbtypes() const noexcept {
+        return txtypes.size();
+    }
+    /** Get the name of a transaction type.
+     * @param type Transaction type
+     * @return Constant null-terminated name
+    **/
+    auto get_type_name(size_t type) const noexcept {
+        return txtypes[type];
+    }
+    /** Get the latencies of a transaction type during the finished repetitions.
+     * @param type Transaction type
+     * @return Latency histogram
+    **/
+    auto const& get_latency(size_t type) const noexcept {
+        return latencies[type];
+    }
+    /** Get the attempts of a transaction type during the finished repetitions.
+     * @param type Transaction type
+     * @return Attempt accounting
+    **/
+    auto const& get_attempts(size_t type) const noexcept {
+        return attempts[type];
+    }
+    /** Get the number of transactions a worker completed during the finished repetitions.
+     * @param uid Unique ID of the worker
+     * @return Number of transactions
+    **/
+    auto get_done(Uid uid) const noexcept {
+        return done[uid];
+    }
+    /** Get the number of transactions all the workers completed during the finished repetitions.
+     * @return Number of transactions
+    **/
+    auto get_done() const noexcept {
+        uint_fast64_t res = 0;
+        for (auto count: done)
+            res += count;
+        return res;
+    }
+protected:
+    /** Declare the transaction types whose latency and attempts are recorded.
+     * @param nbworkers Number of concurrent workers
+     * @param names     Name of each type
+    **/
+    void set_tx_types(size_t nbworkers, ::std::initializer_list<char const*> names) {
+        txtypes.assign(names);
+        running.resize(nbworkers * txtypes.size());
+        latencies.resize(txtypes.size());
+        running_attempts.resize(nbworkers * txtypes.size());
+        attempts.resize(txtypes.size());
+        running_done.resize(nbworkers);
+        done.resize(nbworkers);
+    }
+    /** [thread-safe] Get the attempt accounting of the given worker, to select for the transactions of the given type.
+     * @param uid  Unique ID of the worker
+     * @param type Transaction type
+     * @return Attempt accounting
+    **/
+    Attempts& attempts_of(Uid uid, size_t type) const noexcept {
+        return running_attempts[uid * txtypes.size() + type];
+    }
+    /** [thread-safe] Check whether a worker must run another transaction in the current repetition.
+     * The clock is only read every few transactions, so that time-bounded repetitions do not pay for it on each one.
+     * @param count Number of transactions the worker completed in the current repetition
+     * @param limit Number of transactions per worker, when not time-bounded
+     * @return Whether to run another transaction
+    **/
+    bool proceed(size_t count, size_t limit) const noexcept {
+        if (duration == 0)
+            return count < limit;
+        return count % 16 != 0 || Chrono::get_time() < deadline;
+    }
+    /** [thread-safe] Start measuring the latency of the next transaction of a worker.
+     * In open loop, the transaction is first held until its scheduled arrival, and its latency is measured from that arrival
+     * rather than from its actual start: the time it spends queued behind late transactions is accounted for (no coordinated omission).
+     * @param latency Chrono to start
+     * @param engine  Randomness source of the arrivals of the worker
+     * @param arrival Scheduled arrival of the previous transaction of the worker (initially 'get_origin()'), updated
+    **/
+    void pace(Chrono& latency, ::std::minstd_rand& engine, Chrono::Tick& arrival) const {
+        if (interval <= 0.) {
+            latency.start();
+            return;
+        }
+        arrival += static_cast<Chrono::Tick>(::std::exponential_distribution<double>{1. / interval}(engine));
+        for (auto now = Chrono::get_time(); now < arrival; now = Chrono::get_time()) { // Early: wait, yielding the processor unless the arrival is imminent
+            if (arrival - now > 100000)
+                ::std::this_thread::sleep_for(::std::chrono::nanoseconds{arrival - now - 50000});
+            else
+                short_pause();
+        }
+        latency.start(arrival);
+    }
+    /** [thread-safe] Get the origin of the arrivals of the current repetition.
+     * @return Start of the current repetition
+    **/
+    auto get_origin() const noexcept {
+        return origin;
+    }
+    /** [thread-safe] Record the number of transactions a worker completed in the current repetition.
+     * @param uid   Unique ID of the worker
+     * @param count Number of transactions
+    **/
+    void complete(Uid uid, size_t count) const noexcept {
+        running_done[uid] = count;
+    }
+    /** [thread-safe] Record the latency of a transaction, in the histograms of the given worker.
+     * @param uid  Unique ID of the worker
+     * @param type Transaction type
+     * @param tick Latency (in ns)
+    **/
+    void record(Uid uid, size_t type, Chrono::Tick tick) const noexcept {
+        running[uid * txtypes.size() + type].record(tick);
+    }
+    /** [thread-safe] Run a check in phases: every worker runs each phase concurrently, and the first worker alone verifies the shared memory before the first phase and after each one.
+     * @param uid     Unique ID of the worker
+     * @param barrier Barrier synchronizing all the workers
+     * @param verify  Verification (-> char const*, 'nullptr' for no error)
+     * @param phases  Per-worker phases (-> char const*, 'nullptr' for no error)
+     * @return Constant null-terminated error message found by any worker, 'nullptr' for none
+    **/
+    template<class Verify, class... Phases> char const* check_phases(Uid uid, Barrier const& barrier, Verify&& verify, Phases&&... phases) const {
+        auto report = [&](char const* error) {
+            if (unlikely(error))
+                failure.store(error, ::std::memory_order_relaxed);
+        };
+        auto verified = [&]() {
+            barrier.sync();
+            if (uid == 0)
+                report(verify());
+            barrier.sync();
+        };
+        if (uid == 0)
+            failure.store(nullptr, ::std::memory_order_relaxed);
+        verified();
+        ((report(phases()), verified()), ...);
+        return failure.load(::std::memory_order_relaxed);
+    }
 public:
     /** Shared memory (re)initialization.
      * @return Constant null-terminated error message, 'nullptr' for none
@@ -140,7 +521,16 @@ private:
     Balance init_balance;  // Initial account balance
     float   prob_long;     // Probability of running a long, read-only control transaction
     float   prob_alloc;    // Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+    AccessPattern access;  // Distribution of the accounts a short transaction transfers between
     Barrier barrier;       // Barrier for thread synchronization during 'check'
+private:
+    /** Transaction types whose latency is recorded.
+    **/
+    enum TxType: size_t {
+        tx_long,
+        tx_alloc,
+        tx_short
+    };
 public:
     /** Bank workload constructor.
      * @param library       Transactional library to use
@@ -151,25 +541,32 @@ public:
      * @param init_balance  Initial account balance
      * @param prob_long     Probability of running a long, read-only control transaction
      * @param prob_alloc    Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+     * @param access        Distribution of the accounts a short transaction transfers between
+     * @param logpath       Path to the log file making the accounts durable ('nullptr' for non-durable accounts)
     **/
-    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, barrier{static_cast<Barrier::Counter>(nbworkers)} {}
+    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc, AccessPattern const& access, char const* logpath = nullptr): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts), logpath}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, access{access}, barrier{static_cast<Barrier::Counter>(nbworkers)} {
+        set_tx_types(nbworkers, {"long", "alloc", "short"});
+    }
 private:
     /** Long read-only transaction, summing the balance of each account.
      * @param count Loosely-updated number of accounts
      * @return Whether no inconsistency has been found
     **/
     bool long_tx(size_t& nbaccounts) const {
-        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+        TransactionalMemory::Hints hints{expnbaccounts, 0, STM::Hint::scan}; // About one read per account
+        return transactional(tm, Transaction::Mode::read_only, hints, [&](Transaction& tx) {
             auto count = 0ul; // Total number of accounts seen.
             auto sum   = Balance{0}; // Total balance on all seen accounts + parity ammount.
             auto start = tm.get_start(); // The list of accounts starts at the first word of the shared memory region.
+            ::std::vector<Balance> locals; // Private copy of the balances of the current segment.
             while (start) {
                 AccountSegment segment{tx, start}; // We interpret the memory as a segment/array of accounts.
                 decltype(count) segment_count = segment.count;
                 count += segment_count; // And accumulate the total number of accounts.
                 sum += segment.parity; // We also sum the money that results from the destruction of accounts.
-                for (decltype(count) i = 0; i < segment_count; ++i) {
-                    Balance local = segment.accounts[i];
+                locals.resize(segment_count);
+                segment.accounts.read(0, segment_count, locals.data()); // One batched read for the whole segment.
+                for (auto local: locals) {
                     if (unlikely(local < 0)) // If one account has a negative balance, there's a consistency issue.
                         return false;
                     sum += local;
@@ -230,7 +627,8 @@ private:
      * @return Whether the parameters were satisfying and the transaction committed on useful work
     **/
     bool short_tx(size_t send_id, size_t recv_id) const {
-        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+        TransactionalMemory::Hints hints{4, 2, STM::Hint::small}; // Both accounts, the rest in the first segment
+        return transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) {
             void* send_ptr = nullptr;
             void* recv_ptr = nullptr;
 
@@ -262,14 +660,12 @@ private:
                     return false; // At least one account does not exist => do nothing
             }
 
-            // Transfer the money if enough fund
-            Shared<Balance> sender{tx, send_ptr}; // Shared is a template that overloads copy to use tm_read/tm_write.
+            // Transfer the money if enough fund, as two commutative additions: the sender's floor keeps it
+            // non-negative, and the receiver's balance is never read, so concurrent transfers to it do not conflict.
+            Shared<Balance> sender{tx, send_ptr};
             Shared<Balance> recver{tx, recv_ptr};
-            auto send_val = sender.read();
-            if (send_val > 0) {
-                sender = send_val - 1;
-                recver = recver.read() + 1;
-            }
+            if (sender.add(-1, 0))
+                recver.add(1);
             return true;
         });
     }
@@ -294,26 +690,43 @@ public:
     }
 
     /**
-     * Run nbtxperwrk random transactions until completion.
+     * Run nbtxperwrk random transactions until completion, or random transactions until the deadline when time-bounded.
      * @param seed Randomness source
     **/
-    virtual char const* run(Uid uid [[gnu::unused]], Seed seed) const {
+    virtual char const* run(Uid uid, Seed seed) const {
         ::std::minstd_rand engine{seed};
         ::std::bernoulli_distribution long_dist{prob_long};
         ::std::bernoulli_distribution alloc_dist{prob_alloc};
         ::std::gamma_distribution<float> alloc_trigger(expnbaccounts, 1);
         size_t count = nbaccounts;
-        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+        auto accounts = access.sampler(count); // Rebuilt when the number of accounts changes
+        ::std::minstd_rand arrivals{~seed}; // Apart from 'engine', so that the transaction mix does not depend on the loop
+        auto arrival = get_origin();
+        Chrono latency; // Latency of each transaction, including its retries (and its queueing, in open loop)
+        size_t cntr = 0;
+        for (; proceed(cntr, nbtxperwrk); ++cntr) {
             if (long_dist(engine)) { // We roll a dice and, if "lucky", run a long transaction.
+                Attempts::Scope accounting{attempts_of(uid, tx_long)};
+                pace(latency, arrivals, arrival);
                 if (unlikely(!long_tx(count))) // If it fails, then we return an error message.
                     return "Violated isolation or atomicity";
+                record(uid, tx_long, latency.delta());
             } else if (alloc_dist(engine)) { // Let's roll a dice again to trigger an allocation transaction.
-                alloc_tx(alloc_trigger(engine));
+                auto trigger = alloc_trigger(engine);
+                Attempts::Scope accounting{attempts_of(uid, tx_alloc)};
+                pace(latency, arrivals, arrival);
+                alloc_tx(trigger);
+                record(uid, tx_alloc, latency.delta());
             } else { // No luck with previous rolls, let's just run a short transaction.
-                ::std::uniform_int_distribution<size_t> account{0, count - 1};
-                while (unlikely(!short_tx(account(engine), account(engine))));
+                if (accounts.get_size() != count)
+                    accounts = access.sampler(count);
+                Attempts::Scope accounting{attempts_of(uid, tx_short)};
+                pace(latency, arrivals, arrival);
+                while (unlikely(!short_tx(accounts(engine), accounts(engine))));
+                record(uid, tx_short, latency.delta());
             }
         }
+        complete(uid, cntr);
         { // Last long transaction
             size_t dummy;
             if (!long_tx(dummy))
@@ -360,12 +773,22 @@ public:
             });
 
             // And then we decrease the value of the counter after checking that it didn't increase since the last read.
+            // If the library supports nesting, a scope given up on must first leave no trace, and the decrease runs in its own scope.
             auto correct = transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
                 Shared<size_t> counter{tx, tm.get_start()};
                 auto value = counter.read();
                 if (unlikely(value > last))
                     return false;
-                counter = value - 1;
+                if (tx.begin_nested()) {
+                    counter = 0;
+                    if (unlikely(!tx.rollback_nested()))
+                        throw Exception::TransactionRetry{};
+                    if (unlikely(counter.read() != value))
+                        return false;
+                }
+                nested(tx, [&](Transaction&) {
+                    counter = value - 1;
+                });
                 return true;
             });
             if (unlikely(!correct)) {
@@ -387,3 +810,2198 @@ public:
         return nullptr;
     }
 };
+
+/** Container workload base class: the workers insert and remove elements, and the net number of insertions gives the expected size.
+**/
+class WorkloadContainer: public Workload {
+private:
+    ::std::atomic<intptr_t> mutable growth; // Net number of elements the workers inserted since the initialization
+public:
+    /** Transactional memory constructor.
+     * @param library Transactional library to use
+     * @param align   Shared memory region required alignment
+     * @param size    Size of the shared memory region to allocate
+     * @param logpath Path to the log file making the region durable ('nullptr' for a non-durable region)
+    **/
+    WorkloadContainer(TransactionalLibrary const& library, size_t align, size_t size, char const* logpath = nullptr): Workload{library, align, size, logpath}, growth{0} {}
+protected:
+    /** Forget the insertions and removals of the workers, on (re)initialization.
+    **/
+    void reset_growth() const noexcept {
+        growth.store(0, ::std::memory_order_relaxed);
+    }
+    /** [thread-safe] Account the net number of elements a worker inserted.
+     * @param grown Number of insertions minus number of removals
+    **/
+    void grow(intptr_t grown) const noexcept {
+        growth.fetch_add(grown, ::std::memory_order_relaxed);
+    }
+    /** Get the net number of elements the workers inserted since the initialization.
+     * @return Number of insertions minus number of removals
+    **/
+    auto get_growth() const noexcept {
+        return growth.load(::std::memory_order_relaxed);
+    }
+};
+
+/** Sorted linked-list set workload class: long read sets (the traversal) with small write sets.
+**/
+class WorkloadLinkedList final: public WorkloadContainer {
+public:
+    /** Key class alias.
+    **/
+    using Key = intptr_t;
+private:
+    /** Shared list node (the first one, at the start of the shared memory region, being the head sentinel).
+    **/
+    struct Node {
+        Key   key;  // Key of the element (undefined for the head sentinel)
+        Node* next; // Next node, 'nullptr' at the end of the list
+    };
+    /** Transaction types whose latency is recorded.
+    **/
+    enum TxType: size_t {
+        tx_contains,
+        tx_insert,
+        tx_remove
+    };
+    /** Position of a key in the list.
+    **/
+    struct Position {
+        Node* pred; // Last node with a smaller key (maybe the head sentinel)
+        Node* curr; // Next node, 'nullptr' at the end of the list
+        Node  node; // Copy of the next node (undefined at the end of the list)
+    };
+private:
+    size_t  nbworkers;   // Number of concurrent workers
+    size_t  nbtxperwrk;  // Number of transactions per worker
+    size_t  key_range;   // Number of keys an operation draws from, the list initially holding every other one
+    float   prob_update; // Probability of an update, half of them insertions and half removals, rather than a lookup
+    AccessPattern access; // Distribution of the keys of the operations
+    Barrier barrier;     // Barrier for thread synchronization during 'check'
+public:
+    /** Linked-list workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param key_range   Number of keys an operation draws from, the list initially holding every other one
+     * @param prob_update Probability of an update, half of them insertions and half removals, rather than a lookup
+     * @param access      Distribution of the keys of the operations
+     * @param logpath     Path to the log file making the list durable ('nullptr' for a non-durable list)
+    **/
+    WorkloadLinkedList(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t key_range, float prob_update, AccessPattern const& access, char const* logpath = nullptr): WorkloadContainer{library, alignof(Node), sizeof(Node), logpath}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, key_range{key_range}, prob_update{prob_update}, access{access}, barrier{static_cast<Barrier::Counter>(nbworkers)} {
+        set_tx_types(nbworkers, {"contains", "insert", "remove"});
+    }
+private:
+    /** Get the expected footprint of an operation, which traverses half of the list on average.
+     * @param writes Expected number of writes
+     * @return Hints
+    **/
+    TransactionalMemory::Hints hints(size_t writes) const noexcept {
+        return TransactionalMemory::Hints{key_range / 4 + 1, writes, STM::Hint::scan};
+    }
+    /** Find the position of a key in the list.
+     * @param tx  Current transaction
+     * @param key Key to look for
+     * @return Position of the key
+    **/
+    Position find(Transaction& tx, Key key) const {
+        Position res;
+        res.pred = reinterpret_cast<Node*>(tm.get_start());
+        res.curr = Shared<Node>{tx, res.pred}.read().next;
+        while (res.curr) {
+            res.node = Shared<Node>{tx, res.curr}.read(); // Key and next pointer in one read
+            if (res.node.key >= key)
+                break;
+            res.pred = res.curr;
+            res.curr = res.node.next;
+        }
+        return res;
+    }
+    /** Lookup transaction.
+     * @param key Key to look for
+     * @return Whether the key is in the set
+    **/
+    bool contains(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, hints(0), [&](Transaction& tx) {
+            auto pos = find(tx, key);
+            return pos.curr && pos.node.key == key;
+        });
+    }
+    /** Insertion transaction.
+     * @param key Key to insert
+     * @return Whether the key was not already in the set
+    **/
+    bool insert(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, hints(3), [&](Transaction& tx) {
+            auto pos = find(tx, key);
+            if (pos.curr && pos.node.key == key)
+                return false;
+            auto node = reinterpret_cast<Node*>(tx.alloc(sizeof(Node)));
+            Shared<Node>{tx, node} = Node{key, pos.curr};
+            Shared<Node*>{tx, &pos.pred->next} = node;
+            return true;
+        });
+    }
+    /** Removal transaction.
+     * @param key Key to remove
+     * @return Whether the key was in the set
+    **/
+    bool remove(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, hints(1), [&](Transaction& tx) {
+            auto pos = find(tx, key);
+            if (!pos.curr || pos.node.key != key)
+                return false;
+            Shared<Node*>{tx, &pos.pred->next} = pos.node.next;
+            tx.free(pos.curr);
+            return true;
+        });
+    }
+    /** Check that the list is sorted and holds the expected number of elements.
+     * @return Constant null-terminated error message, 'nullptr' for none
+    **/
+    char const* verify() const {
+        auto expected = static_cast<intptr_t>((key_range + 1) / 2) + get_growth();
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            intptr_t size = 0;
+            auto last = ::std::numeric_limits<Key>::min();
+            for (auto curr = Shared<Node>{tx, tm.get_start()}.read().next; curr; ++size) {
+                auto node = Shared<Node>{tx, curr}.read();
+                if (unlikely(size > 0 && node.key <= last))
+                    return "Violated isolation or atomicity (unsorted list)";
+                last = node.key;
+                curr = node.next;
+            }
+            if (unlikely(size != expected))
+                return "Violated isolation or atomicity (unexpected list size)";
+            return nullptr;
+        });
+    }
+public:
+    /**
+     * (Re)build the list with every other key of the range, in a single transaction so that concurrent initializations do not mix.
+    **/
+    virtual char const* init() const {
+        reset_growth();
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto head = reinterpret_cast<Node*>(tm.get_start());
+            for (auto curr = Shared<Node>{tx, head}.read().next; curr;) { // Free the previous elements, if any
+                auto next = Shared<Node>{tx, curr}.read().next;
+                tx.free(curr);
+                curr = next;
+            }
+            auto pred = head;
+            for (size_t key = 0; key < key_range; key += 2) {
+                auto node = reinterpret_cast<Node*>(tx.alloc(sizeof(Node)));
+                Shared<Node>{tx, node} = Node{static_cast<Key>(key), nullptr};
+                Shared<Node*>{tx, &pred->next} = node;
+                pred = node;
+            }
+            if (pred == head)
+                Shared<Node*>{tx, &head->next} = nullptr;
+        });
+        return verify();
+    }
+    /**
+     * Run nbtxperwrk random operations until completion, or random operations until the deadline when time-bounded.
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution insert_dist{0.5};
+        auto keys = access.sampler(key_range);
+        ::std::minstd_rand arrivals{~seed};
+        auto arrival = get_origin();
+        Chrono latency; // Latency of each transaction, including its retries (and its queueing, in open loop)
+        intptr_t grown = 0; // Net number of elements inserted by this worker
+        size_t cntr = 0;
+        for (; proceed(cntr, nbtxperwrk); ++cntr) {
+            auto key = static_cast<Key>(keys(engine));
+            if (!update_dist(engine)) {
+                Attempts::Scope accounting{attempts_of(uid, tx_contains)};
+                pace(latency, arrivals, arrival);
+                contains(key);
+                record(uid, tx_contains, latency.delta());
+            } else if (insert_dist(engine)) {
+                Attempts::Scope accounting{attempts_of(uid, tx_insert)};
+                pace(latency, arrivals, arrival);
+                if (insert(key))
+                    ++grown;
+                record(uid, tx_insert, latency.delta());
+            } else {
+                Attempts::Scope accounting{attempts_of(uid, tx_remove)};
+                pace(latency, arrivals, arrival);
+                if (remove(key))
+                    --grown;
+                record(uid, tx_remove, latency.delta());
+            }
+        }
+        complete(uid, cntr);
+        grow(grown);
+        return nullptr;
+    }
+    /**
+     * Check the list after the runs, then check that concurrent operations on private keys (outside the range) all take effect.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        constexpr size_t nbkeys = 32; // Private keys per worker
+        return check_phases(uid, barrier, [&]() { return verify(); }, [&]() -> char const* {
+            auto first = static_cast<Key>(key_range + uid * nbkeys);
+            for (auto key = first; key < first + static_cast<Key>(nbkeys); ++key) {
+                if (unlikely(!insert(key) || !contains(key)))
+                    return "Violated consistency, isolation or atomicity (lost insertion)";
+            }
+            for (auto key = first; key < first + static_cast<Key>(nbkeys); ++key) {
+                if (unlikely(!remove(key) || contains(key)))
+                    return "Violated consistency, isolation or atomicity (lost removal)";
+            }
+            return nullptr;
+        });
+    }
+};
+
+/** Open hashing (separate chaining) hash map workload class: short transactions with few conflicts, except with the occasional resize.
+**/
+class WorkloadHashMap final: public WorkloadContainer {
+public:
+    /** Key and value class aliases.
+    **/
+    using Key   = intptr_t;
+    using Value = intptr_t;
+private:
+    /** Shared chain node.
+    **/
+    struct Node {
+        Key   key;   // Key of the entry
+        Value value; // Value of the entry, always 'value_of(key)'
+        Node* next;  // Next node of the chain, 'nullptr' at the end
+    };
+    /** Shared table header, at the start of the shared memory region.
+    **/
+    struct Header {
+        Node** buckets;   // Array of chain heads, allocated through 'tm_alloc'
+        size_t nbbuckets; // Number of buckets of the array
+    };
+    /** Transaction types whose latency is recorded.
+    **/
+    enum TxType: size_t {
+        tx_get,
+        tx_put,
+        tx_remove,
+        tx_resize
+    };
+    /** Position of a key in its chain.
+    **/
+    struct Position {
+        Node** bucket; // Bucket of the key
+        Node*  head; // First node of that bucket
+        Node** link; // Shared pointer to the node (the bucket or the 'next' field of the previous node)
+        Node*  curr; // Node holding the key, 'nullptr' if none
+        Node   node; // Copy of that node (undefined if none)
+    };
+private:
+    size_t  nbworkers;   // Number of concurrent workers
+    size_t  nbtxperwrk;  // Number of transactions per worker
+    size_t  nbbuckets;   // Initial number of buckets, resizes alternating between twice this count and this count
+    size_t  nbentries;   // Initial number of entries (i.e. initial load factor times the bucket count)
+    size_t  key_range;   // Number of keys an operation draws from, twice the initial number of entries
+    float   prob_update; // Probability of an update, half of them puts and half removals, rather than a get
+    float   prob_resize; // Probability of a resize rather than any other operation
+    AccessPattern access; // Distribution of the keys of the operations
+    Barrier barrier;     // Barrier for thread synchronization during 'check'
+public:
+    /** Hash map workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbbuckets   Initial number of buckets
+     * @param load_factor Initial number of entries per bucket, operations drawing keys from twice as many
+     * @param prob_update Probability of an update, half of them puts and half removals, rather than a get
+     * @param prob_resize Probability of a resize (allocating a new bucket array) rather than any other operation
+     * @param access      Distribution of the keys of the operations
+     * @param logpath     Path to the log file making the map durable ('nullptr' for a non-durable map)
+    **/
+    WorkloadHashMap(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbbuckets, float load_factor, float prob_update, float prob_resize, AccessPattern const& access, char const* logpath = nullptr): WorkloadContainer{library, alignof(Header), sizeof(Header), logpath}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbbuckets{nbbuckets}, nbentries{static_cast<size_t>(::std::lround(static_cast<double>(load_factor) * static_cast<double>(nbbuckets)))}, key_range{::std::max<size_t>(2 * nbentries, 1)}, prob_update{prob_update}, prob_resize{prob_resize}, access{access}, barrier{static_cast<Barrier::Counter>(nbworkers)} {
+        set_tx_types(nbworkers, {"get", "put", "remove", "resize"});
+    }
+private:
+    /** Value an entry of the given key must have.
+     * @param key Key of the entry
+     * @return Value of the entry
+    **/
+    constexpr static Value value_of(Key key) noexcept {
+        return ~key;
+    }
+    /** Bucket of a key.
+     * @param key       Key to hash
+     * @param nbbuckets Number of buckets
+     * @return Bucket index
+    **/
+    constexpr static size_t bucket_of(Key key, size_t nbbuckets) noexcept {
+        auto hash = static_cast<uint64_t>(key) * UINT64_C(0x9e3779b97f4a7c15); // Fibonacci hashing, then folding the well-mixed high bits
+        return static_cast<size_t>((hash ^ (hash >> 32)) % nbbuckets);
+    }
+    /** Get the expected footprint of an operation, which reads the header, a bucket and about half of its chain.
+     * @param writes Expected number of writes
+     * @return Hints
+    **/
+    TransactionalMemory::Hints hints(size_t writes) const noexcept {
+        return TransactionalMemory::Hints{nbentries / nbbuckets + 3, writes, STM::Hint::small};
+    }
+    /** Find the position of a key in its chain.
+     * @param tx  Current transaction
+     * @param key Key to look for
+     * @return Position of the key
+    **/
+    Position find(Transaction& tx, Key key) const {
+        auto header = Shared<Header>{tx, tm.get_start()}.read();
+        Position res;
+        res.bucket = header.buckets + bucket_of(key, header.nbbuckets);
+        res.head = Shared<Node*>{tx, res.bucket}.read();
+        res.link = res.bucket;
+        res.curr = res.head;
+        while (res.curr) {
+            res.node = Shared<Node>{tx, res.curr}.read(); // Key, value and next pointer in one read
+            if (res.node.key == key)
+                break;
+            res.link = &res.curr->next;
+            res.curr = res.node.next;
+        }
+        return res;
+    }
+    /** Lookup transaction.
+     * @param key Key to look for
+     * @return Whether the key is in the map, none if its entry does not have the expected value
+    **/
+    ::std::optional<bool> get(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, hints(0), [&](Transaction& tx) -> ::std::optional<bool> {
+            auto pos = find(tx, key);
+            if (!pos.curr)
+                return false;
+            if (unlikely(pos.node.value != value_of(key)))
+                return ::std::nullopt;
+            return true;
+        });
+    }
+    /** Insertion or update transaction.
+     * @param key Key of the entry to write
+     * @return Whether the key was not already in the map
+    **/
+    bool put(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, hints(3), [&](Transaction& tx) {
+            auto pos = find(tx, key);
+            if (pos.curr) {
+                Shared<Value>{tx, &pos.curr->value} = value_of(key);
+                return false;
+            }
+            auto node = reinterpret_cast<Node*>(tx.alloc(sizeof(Node)));
+            Shared<Node>{tx, node} = Node{key, value_of(key), pos.head}; // Prepended to the chain
+            Shared<Node*>{tx, pos.bucket} = node;
+            return true;
+        });
+    }
+    /** Removal transaction.
+     * @param key Key of the entry to remove
+     * @return Whether the key was in the map
+    **/
+    bool remove(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, hints(1), [&](Transaction& tx) {
+            auto pos = find(tx, key);
+            if (!pos.curr)
+                return false;
+            Shared<Node*>{tx, pos.link} = pos.node.next;
+            tx.free(pos.curr);
+            return true;
+        });
+    }
+    /** Resize transaction, rehashing every entry into a newly allocated bucket array and freeing the former one.
+     * The array alternates between twice the initial bucket count and the initial bucket count.
+    **/
+    void resize() const {
+        TransactionalMemory::Hints hints{2 * nbentries + 3 * nbbuckets, nbentries + 2 * nbbuckets, STM::Hint::scan};
+        transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) {
+            auto header = Shared<Header>{tx, tm.get_start()}.read();
+            auto count = header.nbbuckets == nbbuckets ? 2 * nbbuckets : nbbuckets;
+            ::std::vector<Node*> heads(count, nullptr);
+            for (size_t i = 0; i < header.nbbuckets; ++i) {
+                for (auto curr = Shared<Node*>{tx, header.buckets + i}.read(); curr;) {
+                    auto node = Shared<Node>{tx, curr}.read();
+                    auto& head = heads[bucket_of(node.key, count)];
+                    Shared<Node*>{tx, &curr->next} = head;
+                    head = curr;
+                    curr = node.next;
+                }
+            }
+            auto buckets = reinterpret_cast<Node**>(tx.alloc(count * sizeof(Node*)));
+            Shared<Node*[]>{tx, buckets}.write(0, count, heads.data());
+            tx.free(header.buckets);
+            Shared<Header>{tx, tm.get_start()} = Header{buckets, count};
+        });
+    }
+    /** Check that every entry is in its bucket with its expected value, that no key is duplicated, and that the map holds the expected number of entries.
+     * @return Constant null-terminated error message, 'nullptr' for none
+    **/
+    char const* verify() const {
+        auto expected = static_cast<intptr_t>(nbentries) + get_growth();
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            auto header = Shared<Header>{tx, tm.get_start()}.read();
+            ::std::vector<Key> keys;
+            for (size_t i = 0; i < header.nbbuckets; ++i) {
+                for (auto curr = Shared<Node*>{tx, header.buckets + i}.read(); curr;) {
+                    auto node = Shared<Node>{tx, curr}.read();
+                    if (unlikely(bucket_of(node.key, header.nbbuckets) != i || node.value != value_of(node.key)))
+                        return "Violated isolation or atomicity (corrupted entry)";
+                    keys.push_back(node.key);
+                    curr = node.next;
+                }
+            }
+            ::std::sort(keys.begin(), keys.end());
+            if (unlikely(::std::adjacent_find(keys.begin(), keys.end()) != keys.end()))
+                return "Violated isolation or atomicity (duplicated key)";
+            if (unlikely(static_cast<intptr_t>(keys.size()) != expected))
+                return "Violated isolation or atomicity (lost or spurious key)";
+            return nullptr;
+        });
+    }
+public:
+    /**
+     * (Re)build the map with every other key of the range, in a single transaction so that concurrent initializations do not mix.
+    **/
+    virtual char const* init() const {
+        reset_growth();
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto header = Shared<Header>{tx, tm.get_start()}.read();
+            if (header.buckets) { // Free the previous entries and bucket array, if any
+                for (size_t i = 0; i < header.nbbuckets; ++i) {
+                    for (auto curr = Shared<Node*>{tx, header.buckets + i}.read(); curr;) {
+                        auto next = Shared<Node>{tx, curr}.read().next;
+                        tx.free(curr);
+                        curr = next;
+                    }
+                }
+                tx.free(header.buckets);
+            }
+            ::std::vector<Node*> heads(nbbuckets, nullptr);
+            for (size_t key = 0; key < key_range; key += 2) {
+                auto& head = heads[bucket_of(static_cast<Key>(key), nbbuckets)];
+                auto node = reinterpret_cast<Node*>(tx.alloc(sizeof(Node)));
+                Shared<Node>{tx, node} = Node{static_cast<Key>(key), value_of(static_cast<Key>(key)), head};
+                head = node;
+            }
+            auto buckets = reinterpret_cast<Node**>(tx.alloc(nbbuckets * sizeof(Node*)));
+            Shared<Node*[]>{tx, buckets}.write(0, nbbuckets, heads.data());
+            Shared<Header>{tx, tm.get_start()} = Header{buckets, nbbuckets};
+        });
+        return verify();
+    }
+    /**
+     * Run nbtxperwrk random operations until completion, or random operations until the deadline when time-bounded.
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution resize_dist{prob_resize};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution put_dist{0.5};
+        auto keys = access.sampler(key_range);
+        ::std::minstd_rand arrivals{~seed};
+        auto arrival = get_origin();
+        Chrono latency; // Latency of each transaction, including its retries (and its queueing, in open loop)
+        intptr_t grown = 0; // Net number of entries inserted by this worker
+        size_t cntr = 0;
+        for (; proceed(cntr, nbtxperwrk); ++cntr) {
+            if (unlikely(resize_dist(engine))) {
+                Attempts::Scope accounting{attempts_of(uid, tx_resize)};
+                pace(latency, arrivals, arrival);
+                resize();
+                record(uid, tx_resize, latency.delta());
+                continue;
+            }
+            auto key = static_cast<Key>(keys(engine));
+            if (!update_dist(engine)) {
+                Attempts::Scope accounting{attempts_of(uid, tx_get)};
+                pace(latency, arrivals, arrival);
+                auto found = get(key);
+                record(uid, tx_get, latency.delta());
+                if (unlikely(!found))
+                    return "Violated isolation or atomicity (torn entry)";
+            } else if (put_dist(engine)) {
+                Attempts::Scope accounting{attempts_of(uid, tx_put)};
+                pace(latency, arrivals, arrival);
+                if (put(key))
+                    ++grown;
+                record(uid, tx_put, latency.delta());
+            } else {
+                Attempts::Scope accounting{attempts_of(uid, tx_remove)};
+                pace(latency, arrivals, arrival);
+                if (remove(key))
+                    --grown;
+                record(uid, tx_remove, latency.delta());
+            }
+        }
+        complete(uid, cntr);
+        grow(grown);
+        return nullptr;
+    }
+    /**
+     * Check the map after the runs, then check that concurrent operations on private keys (outside the range) all take effect, across a resize.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        constexpr size_t nbkeys = 32; // Private keys per worker
+        return check_phases(uid, barrier, [&]() { return verify(); }, [&]() -> char const* {
+            auto first = static_cast<Key>(key_range + uid * nbkeys);
+            for (auto key = first; key < first + static_cast<Key>(nbkeys); ++key) {
+                if (unlikely(!put(key) || get(key) != true))
+                    return "Violated consistency, isolation or atomicity (lost put)";
+            }
+            if (uid == 0)
+                resize();
+            for (auto key = first; key < first + static_cast<Key>(nbkeys); ++key) {
+                if (unlikely(put(key) || !remove(key) || get(key) != false))
+                    return "Violated consistency, isolation or atomicity (lost removal)";
+            }
+            return nullptr;
+        });
+    }
+};
+
+/** Skip list set workload class: short point operations, and range scans whose read sets have a configurable length.
+**/
+class WorkloadSkipList final: public WorkloadContainer {
+public:
+    /** Key class alias.
+    **/
+    using Key = intptr_t;
+    /** Maximal height of a tower.
+    **/
+    constexpr static size_t max_height = 16;
+private:
+    /** Shared node (the first one, at the start of the shared memory region, being the head sentinel of full height).
+    **/
+    struct Node {
+        Key    key;              // Key of the element (undefined for the head sentinel)
+        size_t height;           // Height of the tower, in [1, max_height]
+        Node*  next[max_height]; // Next node at each level, only the first 'height' ones being allocated
+    };
+    /** Size of a node with a tower of the given height.
+     * @param height Height of the tower
+     * @return Size to allocate (in bytes)
+    **/
+    constexpr static size_t size_of(size_t height) noexcept {
+        return offsetof(Node, next) + height * sizeof(Node*);
+    }
+    /** Transaction types whose latency is recorded.
+    **/
+    enum TxType: size_t {
+        tx_lookup,
+        tx_insert,
+        tx_delete,
+        tx_scan
+    };
+    /** Position of a key in the list.
+    **/
+    struct Position {
+        Node* preds[max_height]; // Last node with a smaller key at each level (maybe the head sentinel)
+        Node* succs[max_height]; // Next node at each level, 'nullptr' at the end of the list
+        Key   key;               // Key of the next node at the lowest level (undefined at the end of the list)
+    };
+private:
+    size_t  nbworkers;   // Number of concurrent workers
+    size_t  nbtxperwrk;  // Number of transactions per worker
+    size_t  key_range;   // Number of keys an operation draws from, the list initially holding every other one
+    size_t  nblevels;    // Number of levels worth traversing for this key range
+    float   prob_update; // Probability of an update, half of them insertions and half deletions, rather than a lookup
+    float   prob_scan;   // Probability of a range scan rather than any other operation
+    size_t  scan_length; // Number of elements a range scan reads
+    AccessPattern access; // Distribution of the keys of the operations
+    Barrier barrier;     // Barrier for thread synchronization during 'check'
+public:
+    /** Skip list workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param key_range   Number of keys an operation draws from, the list initially holding every other one
+     * @param prob_update Probability of an update, half of them insertions and half deletions, rather than a lookup
+     * @param prob_scan   Probability of a range scan rather than any other operation
+     * @param scan_length Number of elements a range scan reads
+     * @param access      Distribution of the keys of the operations (and of the first keys of the scans)
+     * @param logpath     Path to the log file making the list durable ('nullptr' for a non-durable list)
+    **/
+    WorkloadSkipList(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t key_range, float prob_update, float prob_scan, size_t scan_length, AccessPattern const& access, char const* logpath = nullptr): WorkloadContainer{library, alignof(Node), sizeof(Node), logpath}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, key_range{key_range}, nblevels{1}, prob_update{prob_update}, prob_scan{prob_scan}, scan_length{scan_length}, access{access}, barrier{static_cast<Barrier::Counter>(nbworkers)} {
+        while (nblevels < max_height && (size_t{1} << nblevels) < key_range)
+            ++nblevels;
+        set_tx_types(nbworkers, {"lookup", "insert", "delete", "scan"});
+    }
+private:
+    /** Draw the height of a new tower, each level being kept with probability 1/2.
+     * @param engine Random engine
+     * @return Height of the tower
+    **/
+    template<class Engine> static size_t draw_height(Engine& engine) {
+        ::std::geometric_distribution<size_t> dist{0.5};
+        return ::std::min(dist(engine) + 1, max_height);
+    }
+    /** Get the expected footprint of a point operation, which reads about two nodes per level.
+     * @param writes Expected number of writes
+     * @return Hints
+    **/
+    TransactionalMemory::Hints hints(size_t writes) const noexcept {
+        return TransactionalMemory::Hints{4 * nblevels + 2, writes, STM::Hint::small};
+    }
+    /** Find the position of a key in the list, descending from the top level.
+     * @param tx  Current transaction
+     * @param key Key to look for
+     * @return Position of the key
+    **/
+    Position find(Transaction& tx, Key key) const {
+        Position res;
+        auto pred = reinterpret_cast<Node*>(tm.get_start());
+        for (auto level = max_height; level-- > 0;) {
+            Node* curr = Shared<Node*>{tx, &pred->next[level]};
+            while (curr) {
+                res.key = Shared<Key>{tx, &curr->key};
+                if (res.key >= key)
+                    break;
+                pred = curr;
+                curr = Shared<Node*>{tx, &pred->next[level]};
+            }
+            res.preds[level] = pred;
+            res.succs[level] = curr;
+        }
+        return res;
+    }
+    /** Lookup transaction.
+     * @param key Key to look for
+     * @return Whether the key is in the set
+    **/
+    bool lookup(Key key) const {
+        return transactional(tm, Transaction::Mode::read_only, hints(0), [&](Transaction& tx) {
+            auto pos = find(tx, key);
+            return pos.succs[0] && pos.key == key;
+        });
+    }
+    /** Insertion transaction.
+     * @param key    Key to insert
+     * @param height Height of the tower of the new node
+     * @return Whether the key was not already in the set
+    **/
+    bool insert(Key key, size_t height) const {
+        return transactional(tm, Transaction::Mode::read_write, hints(2 * height + 2), [&](Transaction& tx) {
+            auto pos = find(tx, key);
+            if (pos.succs[0] && pos.key == key)
+                return false;
+            auto node = reinterpret_cast<Node*>(tx.alloc(size_of(height)));
+            Shared<Key>{tx, &node->key} = key;
+            Shared<size_t>{tx, &node->height} = height;
+            Shared<Node*[]>{tx, node->next}.write(0, height, pos.succs);
+            for (size_t level = 0; level < height; ++level)
+                Shared<Node*>{tx, &pos.preds[level]->next[level]} = node;
+            return true;
+        });
+    }
+    /** Deletion transaction.
+     * @param key Key to delete
+     * @return Whether the key was in the set
+    **/
+    bool remove(Key key) const {
+        return transactional(tm, Transaction::Mode::read_write, hints(4), [&](Transaction& tx) {
+            auto pos = find(tx, key);
+            auto node = pos.succs[0];
+            if (!node || pos.key != key)
+                return false;
+            size_t height = Shared<size_t>{tx, &node->height};
+            Node* next[max_height];
+            Shared<Node*[]>{tx, node->next}.read(0, height, next);
+            for (size_t level = 0; level < height; ++level) // The node is the successor at every level of its tower
+                Shared<Node*>{tx, &pos.preds[level]->next[level]} = next[level];
+            tx.free(node);
+            return true;
+        });
+    }
+    /** Range scan transaction, reading the keys of the elements from the given key on.
+     * @param key    First key of the range
+     * @param length Maximal number of elements to read
+     * @param last   Last key of the range (included), the scan stopping at the first larger key
+     * @return Number of elements read, none if they were not in strictly increasing order
+    **/
+    ::std::optional<size_t> scan(Key key, size_t length, Key last = ::std::numeric_limits<Key>::max()) const {
+        TransactionalMemory::Hints hints{4 * nblevels + 2 * length, 0, length > 64 ? STM::Hint::scan : STM::Hint::any};
+        return transactional(tm, Transaction::Mode::read_only, hints, [&](Transaction& tx) -> ::std::optional<size_t> {
+            auto pos = find(tx, key);
+            size_t count = 0;
+            auto prev = key - 1;
+            for (auto curr = pos.succs[0]; curr && count < length; ++count) {
+                Key curr_key = Shared<Key>{tx, &curr->key};
+                if (curr_key > last)
+                    break;
+                if (unlikely(curr_key <= prev))
+                    return ::std::nullopt;
+                prev = curr_key;
+                curr = Shared<Node*>{tx, &curr->next[0]};
+            }
+            return count;
+        });
+    }
+    /** Check that the lowest level is sorted and holds the expected number of elements, and that every higher level links exactly the nodes whose tower reaches it, in the same order.
+     * @return Constant null-terminated error message, 'nullptr' for none
+    **/
+    char const* verify() const {
+        auto expected = static_cast<intptr_t>((key_range + 1) / 2) + get_growth();
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            auto head = reinterpret_cast<Node*>(tm.get_start());
+            Node* cursors[max_height]; // Next node expected at each level
+            Shared<Node*[]>{tx, head->next}.read(0, max_height, cursors);
+            intptr_t size = 0;
+            auto last = ::std::numeric_limits<Key>::min();
+            for (auto curr = cursors[0]; curr; ++size) {
+                Key key = Shared<Key>{tx, &curr->key};
+                size_t height = Shared<size_t>{tx, &curr->height};
+                if (unlikely(size > 0 && key <= last))
+                    return "Violated isolation or atomicity (unsorted list)";
+                if (unlikely(height < 1 || height > max_height))
+                    return "Violated isolation or atomicity (corrupted tower)";
+                Node* next[max_height];
+                Shared<Node*[]>{tx, curr->next}.read(0, height, next);
+                for (size_t level = 1; level < height; ++level) {
+                    if (unlikely(cursors[level] != curr))
+                        return "Violated isolation or atomicity (inconsistent levels)";
+                    cursors[level] = next[level];
+                }
+                last = key;
+                curr = next[0];
+            }
+            for (size_t level = 1; level < max_height; ++level) {
+                if (unlikely(cursors[level] != nullptr))
+                    return "Violated isolation or atomicity (inconsistent levels)";
+            }
+            if (unlikely(size != expected))
+                return "Violated isolation or atomicity (unexpected list size)";
+            return nullptr;
+        });
+    }
+public:
+    /**
+     * (Re)build the list with every other key of the range, in a single transaction so that concurrent initializations do not mix.
+    **/
+    virtual char const* init() const {
+        reset_growth();
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto head = reinterpret_cast<Node*>(tm.get_start());
+            for (Node* curr = Shared<Node*>{tx, &head->next[0]}; curr;) { // Free the previous elements, if any
+                Node* next = Shared<Node*>{tx, &curr->next[0]};
+                tx.free(curr);
+                curr = next;
+            }
+            ::std::minstd_rand engine{static_cast<Seed>(key_range)}; // Same towers at every initialization
+            Node* firsts[max_height] = {}; // First node at each level, built from the largest key down
+            for (auto key = static_cast<Key>((key_range - 1) & ~size_t{1}); key >= 0; key -= 2) {
+                auto height = draw_height(engine);
+                auto node = reinterpret_cast<Node*>(tx.alloc(size_of(height)));
+                Shared<Key>{tx, &node->key} = key;
+                Shared<size_t>{tx, &node->height} = height;
+                Shared<Node*[]>{tx, node->next}.write(0, height, firsts);
+                for (size_t level = 0; level < height; ++level)
+                    firsts[level] = node;
+            }
+            Shared<size_t>{tx, &head->height} = max_height;
+            Shared<Node*[]>{tx, head->next}.write(0, max_height, firsts);
+        });
+        return verify();
+    }
+    /**
+     * Run nbtxperwrk random operations until completion, or random operations until the deadline when time-bounded.
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution scan_dist{prob_scan};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution insert_dist{0.5};
+        auto keys = access.sampler(key_range);
+        ::std::minstd_rand arrivals{~seed};
+        auto arrival = get_origin();
+        Chrono latency; // Latency of each transaction, including its retries (and its queueing, in open loop)
+        intptr_t grown = 0; // Net number of elements inserted by this worker
+        size_t cntr = 0;
+        for (; proceed(cntr, nbtxperwrk); ++cntr) {
+            auto key = static_cast<Key>(keys(engine));
+            if (scan_dist(engine)) {
+                Attempts::Scope accounting{attempts_of(uid, tx_scan)};
+                pace(latency, arrivals, arrival);
+                auto count = scan(key, scan_length);
+                record(uid, tx_scan, latency.delta());
+                if (unlikely(!count))
+                    return "Violated isolation or atomicity (unsorted range)";
+            } else if (!update_dist(engine)) {
+                Attempts::Scope accounting{attempts_of(uid, tx_lookup)};
+                pace(latency, arrivals, arrival);
+                lookup(key);
+                record(uid, tx_lookup, latency.delta());
+            } else if (insert_dist(engine)) {
+                auto height = draw_height(engine); // Drawn once, whatever the number of retries
+                Attempts::Scope accounting{attempts_of(uid, tx_insert)};
+                pace(latency, arrivals, arrival);
+                if (insert(key, height))
+                    ++grown;
+                record(uid, tx_insert, latency.delta());
+            } else {
+                Attempts::Scope accounting{attempts_of(uid, tx_delete)};
+                pace(latency, arrivals, arrival);
+                if (remove(key))
+                    --grown;
+                record(uid, tx_delete, latency.delta());
+            }
+        }
+        complete(uid, cntr);
+        grow(grown);
+        return nullptr;
+    }
+    /**
+     * Check the list after the runs, then check that concurrent operations and scans on private keys (outside the range) all take effect.
+     * @param uid  Id of the thread to run the check
+     * @param seed Randomness source
+    **/
+    virtual char const* check(Uid uid, Seed seed) const {
+        constexpr size_t nbkeys = 32; // Private keys per worker
+        ::std::minstd_rand engine{seed};
+        return check_phases(uid, barrier, [&]() { return verify(); }, [&]() -> char const* {
+            auto first = static_cast<Key>(key_range + uid * nbkeys);
+            auto last  = first + static_cast<Key>(nbkeys) - 1;
+            for (auto key = first; key <= last; ++key) {
+                if (unlikely(!insert(key, draw_height(engine)) || !lookup(key)))
+                    return "Violated consistency, isolation or atomicity (lost insertion)";
+            }
+            if (unlikely(scan(first, nbkeys + 1, last) != nbkeys))
+                return "Violated consistency, isolation or atomicity (incomplete range)";
+            for (auto key = first; key <= last; ++key) {
+                if (unlikely(!remove(key) || lookup(key)))
+                    return "Violated consistency, isolation or atomicity (lost deletion)";
+            }
+            if (unlikely(scan(first, nbkeys + 1, last) != 0))
+                return "Violated consistency, isolation or atomicity (spurious range)";
+            return nullptr;
+        });
+    }
+};
+
+/** B+-tree set workload class: short operations whose splits and merges, done top-down, write the paths near the root.
+**/
+class WorkloadBTree final: public WorkloadContainer {
+public:
+    /** Key class alias.
+    **/
+    using Key = intptr_t;
+    /** Maximal and minimal (except for the root) numbers of keys of a node.
+    **/
+    constexpr static size_t max_keys = 7;
+    constexpr static size_t min_keys = max_keys / 2;
+private:
+    /** Shared node, as large as two cache lines (always read and written whole). Nodes are only word-aligned in the region, so one may straddle a third line.
+    **/
+    struct Node {
+        uint32_t count;                   // Number of keys
+        uint32_t leaf;                    // Whether the node is a leaf (non-zero) or an inner node
+        Key      keys[max_keys];          // Keys, sorted (for an inner node, child i holds keys in [keys[i - 1], keys[i]))
+        Node*    children[max_keys + 1];  // Children of an inner node, unused in a leaf
+    };
+    static_assert(sizeof(Node) % 64 == 0, "B+-tree nodes are expected to be a multiple of the cache line size");
+    /** Number of words of a node.
+    **/
+    constexpr static size_t node_words = sizeof(Node) / sizeof(Key);
+    /** Transaction types whose latency is recorded.
+    **/
+    enum TxType: size_t {
+        tx_lookup,
+        tx_insert,
+        tx_delete
+    };
+private:
+    size_t  nbworkers;   // Number of concurrent workers
+    size_t  nbtxperwrk;  // Number of transactions per worker
+    size_t  key_range;   // Number of keys an operation draws from, the tree initially holding every other one
+    size_t  nblevels;    // Expected height of the tree for this key range
+    float   prob_update; // Probability of an update, half of them insertions and half deletions, rather than a lookup
+    AccessPattern access; // Distribution of the keys of the operations
+    Barrier barrier;     // Barrier for thread synchronization during 'check'
+public:
+    /** B+-tree workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param key_range   Number of keys an operation draws from, the tree initially holding every other one
+     * @param prob_update Probability of an update, half of them insertions and half deletions, rather than a lookup
+     * @param access      Distribution of the keys of the operations
+     * @param logpath     Path to the log file making the tree durable ('nullptr' for a non-durable tree)
+    **/
+    WorkloadBTree(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t key_range, float prob_update, AccessPattern const& access, char const* logpath = nullptr): WorkloadContainer{library, alignof(Node*), sizeof(Node*), logpath}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, key_range{key_range}, nblevels{1}, prob_update{prob_update}, access{access}, barrier{static_cast<Barrier::Counter>(nbworkers)} {
+        for (auto capacity = max_keys; capacity < key_range; capacity *= min_keys + 1)
+            ++nblevels;
+        set_tx_types(nbworkers, {"lookup", "insert", "delete"});
+    }
+private:
+    /** Read a whole node.
+     * @param tx   Current transaction
+     * @param addr Address of the node
+     * @return Private copy of the node
+    **/
+    static Node load(Transaction& tx, Node* addr) {
+        return Shared<Node>{tx, addr}.read();
+    }
+    /** Write a whole node.
+     * @param tx   Current transaction
+     * @param addr Address of the node
+     * @param node Private content of the node
+    **/
+    static void store(Transaction& tx, Node* addr, Node const& node) {
+        Shared<Node>{tx, addr} = node;
+    }
+    /** Index of the child of an inner node whose subtree may hold a key.
+     * @param node Inner node
+     * @param key  Key to look for
+     * @return Child index
+    **/
+    static size_t child_of(Node const& node, Key key) noexcept {
+        return static_cast<size_t>(::std::upper_bound(node.keys, node.keys + node.count, key) - node.keys);
+    }
+    /** Split a full child, the left half staying in place and the right half moving to a new node.
+     * @param tx         Current transaction
+     * @param parent     Private copy of the non-full parent, updated (and to be written by the caller)
+     * @param i          Index of the child in the parent
+     * @param child      Private copy of the child, updated and written
+     * @param child_addr Address of the child
+    **/
+    static void split(Transaction& tx, Node& parent, size_t i, Node& child, Node* child_addr) {
+        Node right{};
+        right.leaf = child.leaf;
+        Key separator;
+        if (child.leaf) { // The separator is copied up: the right leaf starts with it
+            auto keep = max_keys / 2 + 1;
+            right.count = static_cast<uint32_t>(max_keys - keep);
+            ::std::copy(child.keys + keep, child.keys + max_keys, right.keys);
+            child.count = static_cast<uint32_t>(keep);
+            separator = right.keys[0];
+        } else { // The separator is moved up
+            auto keep = max_keys / 2;
+            right.count = static_cast<uint32_t>(max_keys - keep - 1);
+            ::std::copy(child.keys + keep + 1, child.keys + max_keys, right.keys);
+            ::std::copy(child.children + keep + 1, child.children + max_keys + 1, right.children);
+            child.count = static_cast<uint32_t>(keep);
+            separator = child.keys[keep];
+        }
+        auto right_addr = reinterpret_cast<Node*>(tx.alloc(sizeof(Node)));
+        store(tx, right_addr, right);
+        store(tx, child_addr, child);
+        ::std::copy_backward(parent.keys + i, parent.keys + parent.count, parent.keys + parent.count + 1);
+        ::std::copy_backward(parent.children + i + 1, parent.children + parent.count + 1, parent.children + parent.count + 2);
+        parent.keys[i] = separator;
+        parent.children[i + 1] = right_addr;
+        ++parent.count;
+    }
+    /** Merge a right child into its left sibling, both with at most the minimal number of keys, and free it.
+     * @param tx         Current transaction
+     * @param parent     Private copy of the parent, updated (and to be written by the caller)
+     * @param i          Index of the left child in the parent
+     * @param left       Private copy of the left child, updated and written
+     * @param left_addr  Address of the left child
+     * @param right      Private copy of the right child
+     * @param right_addr Address of the right child
+    **/
+    static void merge(Transaction& tx, Node& parent, size_t i, Node& left, Node* left_addr, Node const& right, Node* right_addr) {
+        if (left.leaf) {
+            ::std::copy(right.keys, right.keys + right.count, left.keys + left.count);
+            left.count += right.count;
+        } else { // The separator is moved down
+            left.keys[left.count] = parent.keys[i];
+            ::std::copy(right.keys, right.keys + right.count, left.keys + left.count + 1);
+            ::std::copy(right.children, right.children + right.count + 1, left.children + left.count + 1);
+            left.count += right.count + 1;
+        }
+        store(tx, left_addr, left);
+        tx.free(right_addr);
+        ::std::copy(parent.keys + i + 1, parent.keys + parent.count, parent.keys + i);
+        ::std::copy(parent.children + i + 2, parent.children + parent.count + 1, parent.children + i + 1);
+        --parent.count;
+    }
+    /** Give a child with the minimal number of keys one more, borrowing from a sibling or merging with it.
+     * @param tx         Current transaction
+     * @param parent     Private copy of the parent, updated (and to be written by the caller)
+     * @param i          Index of the child in the parent
+     * @param child      Private copy of the child, updated (or replaced by the merged node) and written
+     * @param child_addr Address of the child, replaced by the one of the merged node
+     * @return Index of the (maybe merged) child in the parent
+    **/
+    static size_t refill(Transaction& tx, Node& parent, size_t i, Node& child, Node*& child_addr) {
+        Node left{};
+        Node right{};
+        if (i > 0) { // Borrow the last key of the left sibling
+            left = load(tx, parent.children[i - 1]);
+            if (left.count > min_keys) {
+                ::std::copy_backward(child.keys, child.keys + child.count, child.keys + child.count + 1);
+                if (child.leaf) {
+                    child.keys[0] = left.keys[left.count - 1];
+                    parent.keys[i - 1] = child.keys[0];
+                } else {
+                    ::std::copy_backward(child.children, child.children + child.count + 1, child.children + child.count + 2);
+                    child.keys[0] = parent.keys[i - 1];
+                    child.children[0] = left.children[left.count];
+                    parent.keys[i - 1] = left.keys[left.count - 1];
+                }
+                --left.count;
+                ++child.count;
+                store(tx, parent.children[i - 1], left);
+                store(tx, child_addr, child);
+                return i;
+            }
+        }
+        if (i < parent.count) { // Borrow the first key of the right sibling
+            right = load(tx, parent.children[i + 1]);
+            if (right.count > min_keys) {
+                if (child.leaf) {
+                    child.keys[child.count] = right.keys[0];
+                    parent.keys[i] = right.keys[1];
+                } else {
+                    child.keys[child.count] = parent.keys[i];
+                    child.children[child.count + 1] = right.children[0];
+                    parent.keys[i] = right.keys[0];
+                    ::std::copy(right.children + 1, right.children + right.count + 1, right.children);
+                }
+                ::std::copy(right.keys + 1, right.keys + right.count, right.keys);
+                --right.count;
+                ++child.count;
+                store(tx, parent.children[i + 1], right);
+                store(tx, child_addr, child);
+                return i;
+            }
+        }
+        if (i > 0) { // Merge into the left sibling
+            auto left_addr = parent.children[i - 1];
+            merge(tx, parent, i - 1, left, left_addr, child, child_addr);
+            child = left;
+            child_addr = left_addr;
+            return i - 1;
+        }
+        merge(tx, parent, i, child, child_addr, right, parent.children[i + 1]); // Merge the right sibling (an inner node has at least one key)
+        return i;
+    }
+    /** Lookup in the tree.
+     * @param tx  Current transaction
+     * @param key Key to look for
+     * @return Whether the key is in the tree
+    **/
+    bool lookup(Transaction& tx, Key key) const {
+        auto node = load(tx, Shared<Node*>{tx, tm.get_start()});
+        while (!node.leaf)
+            node = load(tx, node.children[child_of(node, key)]);
+        return ::std::binary_search(node.keys, node.keys + node.count, key);
+    }
+    /** Insertion in the tree, splitting the full nodes on the way down.
+     * @param tx  Current transaction
+     * @param key Key to insert
+     * @return Whether the key was not already in the tree
+    **/
+    bool insert(Transaction& tx, Key key) const {
+        Shared<Node*> root{tx, tm.get_start()};
+        Node* addr = root;
+        auto node = load(tx, addr);
+        if (node.count == max_keys) { // Full root: the tree grows by one level
+            Node parent{};
+            parent.children[0] = addr;
+            auto parent_addr = reinterpret_cast<Node*>(tx.alloc(sizeof(Node)));
+            split(tx, parent, 0, node, addr);
+            store(tx, parent_addr, parent);
+            root = parent_addr;
+            addr = parent_addr;
+            node = parent;
+        }
+        while (!node.leaf) {
+            auto i = child_of(node, key);
+            auto child_addr = node.children[i];
+            auto child = load(tx, child_addr);
+            if (child.count == max_keys) {
+                split(tx, node, i, child, child_addr);
+                store(tx, addr, node);
+                if (key >= node.keys[i]) {
+                    child_addr = node.children[i + 1];
+                    child = load(tx, child_addr);
+                }
+            }
+            addr = child_addr;
+            node = child;
+        }
+        auto pos = ::std::lower_bound(node.keys, node.keys + node.count, key);
+        if (pos != node.keys + node.count && *pos == key)
+            return false;
+        ::std::copy_backward(pos, node.keys + node.count, node.keys + node.count + 1);
+        *pos = key;
+        ++node.count;
+        store(tx, addr, node);
+        return true;
+    }
+    /** Deletion from the tree, refilling the minimal nodes on the way down.
+     * @param tx  Current transaction
+     * @param key Key to delete
+     * @return Whether the key was in the tree
+    **/
+    bool remove(Transaction& tx, Key key) const {
+        Shared<Node*> root{tx, tm.get_start()};
+        Node* addr = root;
+        auto node = load(tx, addr);
+        while (!node.leaf) {
+            auto i = child_of(node, key);
+            auto child_addr = node.children[i];
+            auto child = load(tx, child_addr);
+            if (child.count <= min_keys) {
+                refill(tx, node, i, child, child_addr);
+                if (node.count == 0) { // Only the root can be emptied, by merging its last two children: the tree shrinks by one level
+                    root = child_addr;
+                    tx.free(addr);
+                } else {
+                    store(tx, addr, node);
+                }
+            }
+            addr = child_addr;
+            node = child;
+        }
+        auto pos = ::std::lower_bound(node.keys, node.keys + node.count, key);
+        if (pos == node.keys + node.count || *pos != key)
+            return false;
+        ::std::copy(pos + 1, node.keys + node.count, pos);
+        --node.count;
+        store(tx, addr, node);
+        return true;
+    }
+    /** Lookup transaction.
+     * @param key Key to look for
+     * @return Whether the key is in the set
+    **/
+    bool lookup(Key key) const {
+        TransactionalMemory::Hints hints{nblevels * node_words + 1, 0, STM::Hint::small};
+        return transactional(tm, Transaction::Mode::read_only, hints, [&](Transaction& tx) {
+            return lookup(tx, key);
+        });
+    }
+    /** Insertion transaction.
+     * @param key Key to insert
+     * @return Whether the key was not already in the set
+    **/
+    bool insert(Key key) const {
+        TransactionalMemory::Hints hints{nblevels * node_words + 1, 3 * node_words, STM::Hint::small};
+        return transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) {
+            return insert(tx, key);
+        });
+    }
+    /** Deletion transaction.
+     * @param key Key to delete
+     * @return Whether the key was in the set
+    **/
+    bool remove(Key key) const {
+        TransactionalMemory::Hints hints{2 * nblevels * node_words + 1, 3 * node_words, STM::Hint::small};
+        return transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) {
+            return remove(tx, key);
+        });
+    }
+    /** Check the B+-tree invariants: every leaf at the same depth, every node but the root at least half full,
+     * keys sorted within each node and bounded by the separators of the ancestors, and the expected number of keys.
+     * @return Constant null-terminated error message, 'nullptr' for none
+    **/
+    char const* verify() const {
+        auto expected = static_cast<intptr_t>((key_range + 1) / 2) + get_growth();
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            struct Pending {
+                Node*  addr;  // Node to check
+                size_t depth; // Depth of the node, the root being at 0
+                Key    low;   // Smallest key allowed in its subtree
+                Key    high;  // Bound (excluded) on the keys of its subtree
+            };
+            ::std::vector<Pending> pending{{Shared<Node*>{tx, tm.get_start()}, 0, ::std::numeric_limits<Key>::min(), ::std::numeric_limits<Key>::max()}};
+            auto leaf_depth = ::std::numeric_limits<size_t>::max();
+            intptr_t size = 0;
+            while (!pending.empty()) {
+                auto [addr, depth, low, high] = pending.back();
+                pending.pop_back();
+                auto node = load(tx, addr);
+                if (unlikely(node.count > max_keys || (depth > 0 && node.count < min_keys) || (!node.leaf && node.count == 0)))
+                    return "Violated isolation or atomicity (unbalanced tree)";
+                for (size_t i = 0; i < node.count; ++i) {
+                    if (unlikely(node.keys[i] < low || node.keys[i] >= high || (i > 0 && node.keys[i] <= node.keys[i - 1])))
+                        return "Violated isolation or atomicity (unsorted tree)";
+                }
+                if (node.leaf) {
+                    if (leaf_depth == ::std::numeric_limits<size_t>::max())
+                        leaf_depth = depth;
+                    if (unlikely(depth != leaf_depth))
+                        return "Violated isolation or atomicity (unbalanced tree)";
+                    size += node.count;
+                    continue;
+                }
+                if (unlikely(depth >= 64))
+                    return "Violated isolation or atomicity (unbalanced tree)";
+                for (size_t i = 0; i <= node.count; ++i)
+                    pending.push_back(Pending{node.children[i], depth + 1, i > 0 ? node.keys[i - 1] : low, i < node.count ? node.keys[i] : high});
+            }
+            if (unlikely(size != expected))
+                return "Violated isolation or atomicity (unexpected tree size)";
+            return nullptr;
+        });
+    }
+public:
+    /**
+     * (Re)build the tree with every other key of the range, in a single transaction so that concurrent initializations do not mix.
+    **/
+    virtual char const* init() const {
+        reset_growth();
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Node*> root{tx, tm.get_start()};
+            ::std::vector<Node*> pending; // Free the previous nodes, if any
+            if (root.read())
+                pending.push_back(root);
+            while (!pending.empty()) {
+                auto addr = pending.back();
+                pending.pop_back();
+                auto node = load(tx, addr);
+                if (!node.leaf)
+                    pending.insert(pending.end(), node.children, node.children + node.count + 1);
+                tx.free(addr);
+            }
+            Node leaf{};
+            leaf.leaf = 1;
+            auto leaf_addr = reinterpret_cast<Node*>(tx.alloc(sizeof(Node)));
+            store(tx, leaf_addr, leaf);
+            root = leaf_addr;
+            for (size_t key = 0; key < key_range; key += 2)
+                insert(tx, static_cast<Key>(key));
+        });
+        return verify();
+    }
+    /**
+     * Run nbtxperwrk random operations until completion, or random operations until the deadline when time-bounded.
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::bernoulli_distribution insert_dist{0.5};
+        auto keys = access.sampler(key_range);
+        ::std::minstd_rand arrivals{~seed};
+        auto arrival = get_origin();
+        Chrono latency; // Latency of each transaction, including its retries (and its queueing, in open loop)
+        intptr_t grown = 0; // Net number of keys inserted by this worker
+        size_t cntr = 0;
+        for (; proceed(cntr, nbtxperwrk); ++cntr) {
+            auto key = static_cast<Key>(keys(engine));
+            if (!update_dist(engine)) {
+                Attempts::Scope accounting{attempts_of(uid, tx_lookup)};
+                pace(latency, arrivals, arrival);
+                lookup(key);
+                record(uid, tx_lookup, latency.delta());
+            } else if (insert_dist(engine)) {
+                Attempts::Scope accounting{attempts_of(uid, tx_insert)};
+                pace(latency, arrivals, arrival);
+                if (insert(key))
+                    ++grown;
+                record(uid, tx_insert, latency.delta());
+            } else {
+                Attempts::Scope accounting{attempts_of(uid, tx_delete)};
+                pace(latency, arrivals, arrival);
+                if (remove(key))
+                    --grown;
+                record(uid, tx_delete, latency.delta());
+            }
+        }
+        complete(uid, cntr);
+        grow(grown);
+        return nullptr;
+    }
+    /**
+     * Check the tree after the runs, then check that concurrent operations on private keys (outside the range) all take effect.
+     * @param uid Id of the thread to run the check
+    **/
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        constexpr size_t nbkeys = 32; // Private keys per worker, enough to split and merge leaves
+        return check_phases(uid, barrier, [&]() { return verify(); }, [&]() -> char const* {
+            auto first = static_cast<Key>(key_range + uid * nbkeys);
+            for (auto key = first; key < first + static_cast<Key>(nbkeys); ++key) {
+                if (unlikely(!insert(key) || !lookup(key)))
+                    return "Violated consistency, isolation or atomicity (lost insertion)";
+            }
+            for (auto key = first; key < first + static_cast<Key>(nbkeys); ++key) {
+                if (unlikely(!remove(key) || lookup(key)))
+                    return "Violated consistency, isolation or atomicity (lost deletion)";
+            }
+            return nullptr;
+        });
+    }
+};
+
+/** Travel reservation workload class, after the 'vacation' application of the STAMP benchmark suite:
+ * customers and three kinds of reservable items (cars, flights, rooms) in separate tables, each one chained hash map.
+**/
+class WorkloadVacation final: public Workload {
+public:
+    /** Identifier class alias.
+    **/
+    using Id = intptr_t;
+    /** Kinds of reservable items.
+    **/
+    enum Kind: size_t {
+        car,
+        flight,
+        room,
+        nbkinds
+    };
+private:
+    /** Shared reservable item.
+    **/
+    struct Item {
+        Id       id;    // Identifier of the item in its table
+        Item*    next;  // Next item of the chain, 'nullptr' at the end
+        intptr_t price; // Current price of a unit
+        intptr_t total; // Number of units, always 'used + free'
+        intptr_t used;  // Number of reserved units
+        intptr_t free;  // Number of available units
+    };
+    /** Shared reservation of a customer.
+    **/
+    struct Booking {
+        intptr_t kind;  // Kind of the reserved item
+        Id       id;    // Identifier of the reserved item
+        intptr_t price; // Price paid
+        Booking* next;  // Next reservation of the customer, 'nullptr' at the end
+    };
+    /** Shared customer.
+    **/
+    struct Customer {
+        Id        id;       // Identifier of the customer
+        Customer* next;     // Next customer of the chain, 'nullptr' at the end
+        Booking*  bookings; // Reservations of the customer, 'nullptr' if none
+    };
+    /** Shared table, its bucket array being allocated through 'tm_alloc'.
+    **/
+    template<class Entry> struct Table {
+        Entry** buckets;   // Array of chain heads
+        size_t  nbbuckets; // Number of buckets of the array
+    };
+    /** Shared tables, at the start of the shared memory region.
+    **/
+    struct Tables {
+        Table<Item>     items[nbkinds]; // Table of each kind of items
+        Table<Customer> customers;      // Table of the customers
+    };
+    /** Transaction types whose latency is recorded.
+    **/
+    enum TxType: size_t {
+        tx_reserve,
+        tx_cancel,
+        tx_admin
+    };
+    /** Item designated by a client or an administrator.
+    **/
+    struct Query {
+        Kind     kind;  // Kind of the item
+        Id       id;    // Identifier of the item
+        bool     add;   // For an administrator update, whether to add units (at the given price) rather than withdraw free ones
+        intptr_t price; // For an administrator update, new price of a unit
+    };
+    /** Number of units added or withdrawn by an administrator update.
+    **/
+    constexpr static intptr_t nbunits = 100;
+private:
+    size_t  nbworkers;    // Number of concurrent workers
+    size_t  nbtxperwrk;   // Number of transactions per worker
+    size_t  nbrelations;  // Number of items of each kind, and of initial customers
+    size_t  nbqueries;    // Number of items a reservation queries, or an administrator update modifies
+    float   prob_reserve; // Probability of a reservation, the other transactions being equally customer deletions and administrator updates
+    AccessPattern access; // Distribution of the queried items
+    Barrier barrier;      // Barrier for thread synchronization during 'check'
+public:
+    /** Vacation workload constructor.
+     * @param library      Transactional library to use
+     * @param nbworkers    Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk   Number of transactions per worker
+     * @param nbrelations  Number of items of each kind, and of initial customers
+     * @param nbqueries    Number of items a reservation queries, or an administrator update modifies
+     * @param prob_reserve Probability of a reservation, the other transactions being equally customer deletions and administrator updates
+     * @param access       Distribution of the queried items
+     * @param logpath      Path to the log file making the tables durable ('nullptr' for non-durable tables)
+    **/
+    WorkloadVacation(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbrelations, size_t nbqueries, float prob_reserve, AccessPattern const& access, char const* logpath = nullptr): Workload{library, alignof(Tables), sizeof(Tables), logpath}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbrelations{nbrelations}, nbqueries{nbqueries}, prob_reserve{prob_reserve}, access{access}, barrier{static_cast<Barrier::Counter>(nbworkers)} {
+        set_tx_types(nbworkers, {"reserve", "cancel", "admin"});
+    }
+private:
+    /** Bucket of an identifier.
+     * @param id        Identifier to hash
+     * @param nbbuckets Number of buckets
+     * @return Bucket index
+    **/
+    constexpr static size_t bucket_of(Id id, size_t nbbuckets) noexcept {
+        return static_cast<size_t>(id) % nbbuckets;
+    }
+    /** Get the shared tables.
+     * @return Address of the tables
+    **/
+    Tables* get_tables() const noexcept {
+        return reinterpret_cast<Tables*>(tm.get_start());
+    }
+    /** Find an entry of a table.
+     * @param tx    Current transaction
+     * @param table Shared table
+     * @param id    Identifier of the entry
+     * @return Shared pointer to the entry (the bucket or the 'next' field of the previous entry), entry ('nullptr' if none)
+    **/
+    template<class Entry> static ::std::tuple<Entry**, Entry*> find(Transaction& tx, Table<Entry>* table, Id id) {
+        auto header = Shared<Table<Entry>>{tx, table}.read();
+        auto link = header.buckets + bucket_of(id, header.nbbuckets);
+        Entry* curr = Shared<Entry*>{tx, link};
+        while (curr && Shared<Id>{tx, &curr->id}.read() != id) {
+            link = &curr->next;
+            curr = Shared<Entry*>{tx, link};
+        }
+        return {link, curr};
+    }
+    /** Allocate a table with empty buckets.
+     * @param tx    Current transaction
+     * @param table Shared table to set
+    **/
+    template<class Entry> void create(Transaction& tx, Table<Entry>* table) const {
+        auto buckets = reinterpret_cast<Entry**>(tx.alloc(nbrelations * sizeof(Entry*)));
+        ::std::vector<Entry*> heads(nbrelations, nullptr);
+        Shared<Entry*[]>{tx, buckets}.write(0, nbrelations, heads.data());
+        Shared<Table<Entry>>{tx, table} = Table<Entry>{buckets, nbrelations};
+    }
+    /** Free a table, if allocated, with its entries.
+     * @param tx    Current transaction
+     * @param table Shared table to free
+     * @param func  Function freeing what an entry owns, called with the entry before it is freed
+    **/
+    template<class Entry, class Func> static void destroy(Transaction& tx, Table<Entry>* table, Func&& func) {
+        auto header = Shared<Table<Entry>>{tx, table}.read();
+        if (!header.buckets)
+            return;
+        for (size_t i = 0; i < header.nbbuckets; ++i) {
+            for (Entry* curr = Shared<Entry*>{tx, header.buckets + i}; curr;) {
+                Entry* next = Shared<Entry*>{tx, &curr->next};
+                func(curr);
+                tx.free(curr);
+                curr = next;
+            }
+        }
+        tx.free(header.buckets);
+    }
+    /** Reservation transaction: query some items, then reserve the most expensive available one of each kind
+     * (which is what a customer without price constraint would do), adding the customer if needed.
+     * @param customer Identifier of the customer
+     * @param queries  Queried items
+     * @return Number of reserved items
+    **/
+    size_t reserve(Id customer, ::std::vector<Query> const& queries) const {
+        TransactionalMemory::Hints hints{8 * queries.size() + 16, 4 * nbkinds + 3, STM::Hint::any};
+        return transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) -> size_t {
+            auto tables = get_tables();
+            Item* best[nbkinds] = {};
+            Item  best_item[nbkinds];
+            for (auto&& query: queries) {
+                auto [link, addr] = find(tx, tables->items + query.kind, query.id);
+                if (!addr)
+                    continue;
+                auto item = Shared<Item>{tx, addr}.read();
+                if (item.free > 0 && (!best[query.kind] || item.price > best_item[query.kind].price)) {
+                    best[query.kind] = addr;
+                    best_item[query.kind] = item;
+                }
+            }
+            if (::std::none_of(best, best + nbkinds, [](Item* addr) { return addr != nullptr; }))
+                return 0;
+            auto [link, addr] = find(tx, &tables->customers, customer);
+            if (!addr) { // New customer, prepended to its chain
+                auto bucket = Shared<Table<Customer>>{tx, &tables->customers}.read();
+                auto head = bucket.buckets + bucket_of(customer, bucket.nbbuckets);
+                addr = reinterpret_cast<Customer*>(tx.alloc(sizeof(Customer)));
+                Shared<Customer>{tx, addr} = Customer{customer, Shared<Customer*>{tx, head}, nullptr};
+                Shared<Customer*>{tx, head} = addr;
+            }
+            Booking* bookings = Shared<Booking*>{tx, &addr->bookings};
+            size_t count = 0;
+            for (size_t kind = 0; kind < nbkinds; ++kind) {
+                if (!best[kind])
+                    continue;
+                auto const& item = best_item[kind];
+                Shared<intptr_t>{tx, &best[kind]->used} = item.used + 1;
+                Shared<intptr_t>{tx, &best[kind]->free} = item.free - 1;
+                auto booking = reinterpret_cast<Booking*>(tx.alloc(sizeof(Booking)));
+                Shared<Booking>{tx, booking} = Booking{static_cast<intptr_t>(kind), item.id, item.price, bookings};
+                bookings = booking;
+                ++count;
+            }
+            Shared<Booking*>{tx, &addr->bookings} = bookings;
+            return count;
+        });
+    }
+    /** Customer deletion transaction, cancelling every reservation of the customer.
+     * @param customer Identifier of the customer
+     * @return Whether the customer existed, none if one of its reservations is of an unknown item
+    **/
+    ::std::optional<bool> cancel(Id customer) const {
+        TransactionalMemory::Hints hints{32, 16, STM::Hint::any};
+        return transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) -> ::std::optional<bool> {
+            auto tables = get_tables();
+            auto [link, addr] = find(tx, &tables->customers, customer);
+            if (!addr)
+                return false;
+            auto entry = Shared<Customer>{tx, addr}.read();
+            for (auto curr = entry.bookings; curr;) {
+                auto booking = Shared<Booking>{tx, curr}.read();
+                if (unlikely(booking.kind < 0 || booking.kind >= static_cast<intptr_t>(nbkinds)))
+                    return ::std::nullopt;
+                auto [item_link, item] = find(tx, tables->items + booking.kind, booking.id);
+                if (unlikely(!item))
+                    return ::std::nullopt;
+                Shared<intptr_t> used{tx, &item->used};
+                Shared<intptr_t> free{tx, &item->free};
+                used = used.read() - 1;
+                free = free.read() + 1;
+                tx.free(curr);
+                curr = booking.next;
+            }
+            Shared<Customer*>{tx, link} = entry.next;
+            tx.free(addr);
+            return true;
+        });
+    }
+    /** Administrator update transaction, adding units to or withdrawing free units from some items.
+     * @param queries Updated items
+    **/
+    void admin(::std::vector<Query> const& queries) const {
+        TransactionalMemory::Hints hints{8 * queries.size(), 6 * queries.size(), STM::Hint::any};
+        transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) {
+            auto tables = get_tables();
+            for (auto&& query: queries) {
+                auto [link, addr] = find(tx, tables->items + query.kind, query.id);
+                if (!addr)
+                    continue;
+                auto item = Shared<Item>{tx, addr}.read();
+                if (query.add) {
+                    item.price  = query.price;
+                    item.total += nbunits;
+                    item.free  += nbunits;
+                } else { // Reserved units are never withdrawn
+                    auto withdrawn = ::std::min(nbunits, item.free);
+                    item.total -= withdrawn;
+                    item.free  -= withdrawn;
+                }
+                Shared<Item>{tx, addr} = item;
+            }
+        });
+    }
+    /** Customer existence transaction.
+     * @param customer Identifier of the customer
+     * @return Whether the customer exists
+    **/
+    bool exists(Id customer) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            return ::std::get<1>(find(tx, &get_tables()->customers, customer)) != nullptr;
+        });
+    }
+    /** Draw the items of a reservation or of an administrator update.
+     * @param engine  Random engine
+     * @param ids     Item identifier sampler
+     * @param queries Drawn items (overwritten)
+    **/
+    template<class Engine> void draw(Engine& engine, AccessPattern::Sampler& ids, ::std::vector<Query>& queries) const {
+        ::std::uniform_int_distribution<size_t> kind_dist{0, nbkinds - 1};
+        ::std::bernoulli_distribution add_dist{0.5};
+        ::std::uniform_int_distribution<intptr_t> price_dist{5, 9};
+        queries.resize(nbqueries);
+        for (auto&& query: queries)
+            query = Query{static_cast<Kind>(kind_dist(engine)), static_cast<Id>(ids(engine)), add_dist(engine), 10 * price_dist(engine)};
+    }
+    /** Check that every item is in its table exactly once, that its units add up, and that its reserved units match the reservations of the customers.
+     * @return Constant null-terminated error message, 'nullptr' for none
+    **/
+    char const* verify() const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            auto tables = Shared<Tables>{tx, tm.get_start()}.read();
+            ::std::vector<intptr_t> used[nbkinds]; // Reserved units of each item, according to the items
+            for (size_t kind = 0; kind < nbkinds; ++kind) {
+                used[kind].assign(nbrelations, -1);
+                auto const& table = tables.items[kind];
+                for (size_t i = 0; i < table.nbbuckets; ++i) {
+                    for (Item* curr = Shared<Item*>{tx, table.buckets + i}; curr;) {
+                        auto item = Shared<Item>{tx, curr}.read();
+                        if (unlikely(item.id < 0 || static_cast<size_t>(item.id) >= nbrelations || bucket_of(item.id, table.nbbuckets) != i || used[kind][item.id] >= 0))
+                            return "Violated isolation or atomicity (corrupted item table)";
+                        if (unlikely(item.used < 0 || item.free < 0 || item.used + item.free != item.total))
+                            return "Violated isolation or atomicity (units do not add up)";
+                        used[kind][item.id] = item.used;
+                        curr = item.next;
+                    }
+                }
+                if (unlikely(::std::find(used[kind].begin(), used[kind].end(), -1) != used[kind].end()))
+                    return "Violated isolation or atomicity (lost item)";
+            }
+            auto const& table = tables.customers;
+            for (size_t i = 0; i < table.nbbuckets; ++i) {
+                for (Customer* curr = Shared<Customer*>{tx, table.buckets + i}; curr;) {
+                    auto customer = Shared<Customer>{tx, curr}.read();
+                    if (unlikely(bucket_of(customer.id, table.nbbuckets) != i))
+                        return "Violated isolation or atomicity (corrupted customer table)";
+                    for (auto booking_addr = customer.bookings; booking_addr;) {
+                        auto booking = Shared<Booking>{tx, booking_addr}.read();
+                        if (unlikely(booking.kind < 0 || booking.kind >= static_cast<intptr_t>(nbkinds) || booking.id < 0 || static_cast<size_t>(booking.id) >= nbrelations))
+                            return "Violated isolation or atomicity (reservation of an unknown item)";
+                        --used[booking.kind][booking.id];
+                        booking_addr = booking.next;
+                    }
+                    curr = customer.next;
+                }
+            }
+            for (auto&& counts: used) {
+                if (unlikely(::std::any_of(counts.begin(), counts.end(), [](intptr_t count) { return count != 0; })))
+                    return "Violated isolation or atomicity (reserved units do not match the reservations)";
+            }
+            return nullptr;
+        });
+    }
+public:
+    /**
+     * (Re)build the tables, each item with some units at some price and each initial customer without reservation,
+     * in a single transaction so that concurrent initializations do not mix.
+    **/
+    virtual char const* init() const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto tables = get_tables();
+            for (auto&& table: tables->items)
+                destroy(tx, &table, [](Item*) {});
+            destroy(tx, &tables->customers, [&](Customer* customer) {
+                for (Booking* curr = Shared<Booking*>{tx, &customer->bookings}; curr;) {
+                    Booking* next = Shared<Booking*>{tx, &curr->next};
+                    tx.free(curr);
+                    curr = next;
+                }
+            });
+            ::std::minstd_rand engine{static_cast<Seed>(nbrelations)}; // Same items at every initialization
+            ::std::uniform_int_distribution<intptr_t> step_dist{1, 5};
+            for (size_t kind = 0; kind < nbkinds; ++kind) {
+                auto table = tables->items + kind;
+                create(tx, table);
+                auto buckets = Shared<Table<Item>>{tx, table}.read().buckets;
+                for (size_t id = 0; id < nbrelations; ++id) {
+                    auto units = nbunits * step_dist(engine);
+                    auto addr = reinterpret_cast<Item*>(tx.alloc(sizeof(Item)));
+                    Shared<Item>{tx, addr} = Item{static_cast<Id>(id), nullptr, 40 + 10 * step_dist(engine), units, 0, units};
+                    Shared<Item*>{tx, buckets + bucket_of(static_cast<Id>(id), nbrelations)} = addr;
+                }
+            }
+            create(tx, &tables->customers);
+            auto buckets = Shared<Table<Customer>>{tx, &tables->customers}.read().buckets;
+            for (size_t id = 0; id < nbrelations; ++id) {
+                auto addr = reinterpret_cast<Customer*>(tx.alloc(sizeof(Customer)));
+                Shared<Customer>{tx, addr} = Customer{static_cast<Id>(id), nullptr, nullptr};
+                Shared<Customer*>{tx, buckets + bucket_of(static_cast<Id>(id), nbrelations)} = addr;
+            }
+        });
+        return verify();
+    }
+    /**
+     * Run nbtxperwrk random client or administrator transactions until completion, or until the deadline when time-bounded.
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution reserve_dist{prob_reserve};
+        ::std::bernoulli_distribution cancel_dist{0.5};
+        ::std::uniform_int_distribution<Id> customer_dist{0, static_cast<Id>(nbrelations) - 1};
+        auto ids = access.sampler(nbrelations);
+        ::std::vector<Query> queries;
+        ::std::minstd_rand arrivals{~seed};
+        auto arrival = get_origin();
+        Chrono latency; // Latency of each transaction, including its retries (and its queueing, in open loop)
+        size_t cntr = 0;
+        for (; proceed(cntr, nbtxperwrk); ++cntr) {
+            if (reserve_dist(engine)) {
+                auto customer = customer_dist(engine);
+                draw(engine, ids, queries);
+                Attempts::Scope accounting{attempts_of(uid, tx_reserve)};
+                pace(latency, arrivals, arrival);
+                reserve(customer, queries);
+                record(uid, tx_reserve, latency.delta());
+            } else if (cancel_dist(engine)) {
+                auto customer = customer_dist(engine);
+                Attempts::Scope accounting{attempts_of(uid, tx_cancel)};
+                pace(latency, arrivals, arrival);
+                auto existed = cancel(customer);
+                record(uid, tx_cancel, latency.delta());
+                if (unlikely(!existed))
+                    return "Violated isolation or atomicity (reservation of an unknown item)";
+            } else {
+                draw(engine, ids, queries);
+                Attempts::Scope accounting{attempts_of(uid, tx_admin)};
+                pace(latency, arrivals, arrival);
+                admin(queries);
+                record(uid, tx_admin, latency.delta());
+            }
+        }
+        complete(uid, cntr);
+        return nullptr;
+    }
+    /**
+     * Check the tables after the runs, then check that concurrent reservations and cancellations of new customers all take effect.
+     * @param uid  Id of the thread to run the check
+     * @param seed Randomness source
+    **/
+    virtual char const* check(Uid uid, Seed seed) const {
+        constexpr size_t nbcustomers = 16; // New customers per worker
+        ::std::minstd_rand engine{seed};
+        auto ids = AccessPattern{}.sampler(nbrelations);
+        ::std::vector<Query> queries;
+        auto first = static_cast<Id>(nbrelations + uid * nbcustomers);
+        return check_phases(uid, barrier, [&]() { return verify(); }, [&]() -> char const* {
+            for (auto customer = first; customer < first + static_cast<Id>(nbcustomers); ++customer) {
+                draw(engine, ids, queries);
+                auto reserved = reserve(customer, queries) > 0;
+                if (unlikely(exists(customer) != reserved))
+                    return "Violated consistency, isolation or atomicity (lost reservation)";
+            }
+            return nullptr;
+        }, [&]() -> char const* {
+            for (auto customer = first; customer < first + static_cast<Id>(nbcustomers); ++customer) {
+                auto existed = exists(customer);
+                if (unlikely(cancel(customer) != existed || exists(customer)))
+                    return "Violated consistency, isolation or atomicity (lost cancellation)";
+            }
+            return nullptr;
+        });
+    }
+};
+
+/** Cut-down TPC-C workload class: warehouses, districts, customers, stocks and orders, with the new-order, payment and order-status transactions.
+ * Every new order increments its district's next order number, and every payment the year-to-date amounts of its warehouse and district: these counters are the hot spots.
+**/
+class WorkloadTpcc final: public Workload {
+public:
+    /** Number of districts per warehouse.
+    **/
+    constexpr static size_t nbdistricts = 10;
+    /** Number of orders each district keeps, older ones being freed.
+    **/
+    constexpr static size_t nbrecent = 8;
+    /** Minimal and maximal numbers of lines of an order.
+    **/
+    constexpr static size_t min_lines = 5;
+    constexpr static size_t max_lines = 15;
+private:
+    /** Shared order line.
+    **/
+    struct OrderLine {
+        intptr_t item;     // Ordered item
+        intptr_t supplier; // Supplying warehouse
+        intptr_t quantity; // Ordered quantity
+        intptr_t amount;   // Price of the line
+    };
+    /** Shared order, allocated with only its lines.
+    **/
+    struct Order {
+        intptr_t  id;              // Order number in its district
+        intptr_t  customer;        // Ordering customer in the district
+        intptr_t  nblines;         // Number of lines, in [min_lines, max_lines]
+        intptr_t  total;           // Sum of the amounts of the lines
+        OrderLine lines[max_lines];
+    };
+    /** Shared customer.
+    **/
+    struct Customer {
+        intptr_t balance;     // Balance, decreased by the payments
+        intptr_t ytd_payment; // Sum of the payments
+        intptr_t payment_cnt; // Number of payments
+        intptr_t last_order;  // Number of the last order in its district, -1 if none
+    };
+    /** Shared district.
+    **/
+    struct District {
+        intptr_t  ytd;              // Year-to-date sum of the payments
+        intptr_t  tax;              // Tax rate (in per ten thousand)
+        intptr_t  next_order;       // Number of the next order
+        intptr_t  nblines;          // Number of order lines ever entered
+        Customer* customers;        // Array of the customers
+        Order*    orders[nbrecent]; // Most recent orders, order n being at n % nbrecent ('nullptr' if none)
+    };
+    /** Shared stock of an item in a warehouse.
+    **/
+    struct Stock {
+        intptr_t quantity;   // Quantity in stock
+        intptr_t ytd;        // Year-to-date ordered quantity
+        intptr_t order_cnt;  // Number of order lines
+        intptr_t remote_cnt; // Number of order lines from another warehouse
+    };
+    /** Shared warehouse.
+    **/
+    struct Warehouse {
+        intptr_t  ytd;       // Year-to-date sum of the payments
+        intptr_t  tax;       // Tax rate (in per ten thousand)
+        District* districts; // Array of the districts
+        Stock*    stocks;    // Array of the stocks, one per item
+    };
+    /** Shared database, at the start of the shared memory region.
+    **/
+    struct Database {
+        Warehouse* warehouses; // Array of the warehouses
+        intptr_t*  prices;     // Array of the item prices
+    };
+    /** Transaction types whose latency is recorded.
+    **/
+    enum TxType: size_t {
+        tx_new_order,
+        tx_payment,
+        tx_order_status
+    };
+private:
+    size_t  nbworkers;    // Number of concurrent workers
+    size_t  nbtxperwrk;   // Number of transactions per worker
+    size_t  nbwarehouses; // Number of warehouses, each worker having its home one
+    size_t  nbcustomers;  // Number of customers per district
+    size_t  nbitems;      // Number of items
+    AccessPattern access; // Distribution of the customers and items
+    Barrier barrier;      // Barrier for thread synchronization during 'check'
+public:
+    /** TPC-C workload constructor.
+     * @param library      Transactional library to use
+     * @param nbworkers    Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk   Number of transactions per worker
+     * @param nbwarehouses Number of warehouses
+     * @param nbcustomers  Number of customers per district
+     * @param nbitems      Number of items
+     * @param access       Distribution of the customers and items
+     * @param logpath      Path to the log file making the database durable ('nullptr' for a non-durable database)
+    **/
+    WorkloadTpcc(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbwarehouses, size_t nbcustomers, size_t nbitems, AccessPattern const& access, char const* logpath = nullptr): Workload{library, alignof(Database), sizeof(Database), logpath}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbwarehouses{nbwarehouses}, nbcustomers{nbcustomers}, nbitems{nbitems}, access{access}, barrier{static_cast<Barrier::Counter>(nbworkers)} {
+        set_tx_types(nbworkers, {"new_order", "payment", "order_status"});
+    }
+private:
+    /** Size of an order.
+     * @param nblines Number of lines
+     * @return Size to allocate (in bytes)
+    **/
+    constexpr static size_t size_of(size_t nblines) noexcept {
+        return offsetof(Order, lines) + nblines * sizeof(OrderLine);
+    }
+    /** Allocate and write an array.
+     * @param tx     Current transaction
+     * @param values Private contents of the array
+     * @return Address of the array
+    **/
+    template<class Type> static Type* create(Transaction& tx, ::std::vector<Type> const& values) {
+        auto addr = reinterpret_cast<Type*>(tx.alloc(values.size() * sizeof(Type)));
+        Shared<Type[]>{tx, addr}.write(0, values.size(), values.data());
+        return addr;
+    }
+    /** Get the shared database.
+     * @param tx Current transaction
+     * @return Private copy of the database header
+    **/
+    Database database(Transaction& tx) const {
+        return Shared<Database>{tx, tm.get_start()}.read();
+    }
+    /** New-order transaction: take the next order number of the district, take the ordered quantities from the stocks, and record the order.
+     * @param warehouse Home warehouse
+     * @param district  District in the home warehouse
+     * @param customer  Ordering customer in the district
+     * @param lines     Order lines (only the item, supplier and quantity being set)
+     * @return Order number
+    **/
+    intptr_t new_order(size_t warehouse, size_t district, size_t customer, ::std::vector<OrderLine> const& lines) const {
+        TransactionalMemory::Hints hints{6 * lines.size() + 24, 5 * lines.size() + 12, STM::Hint::any};
+        return transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) {
+            auto db = database(tx);
+            auto home = Shared<Warehouse>{tx, db.warehouses + warehouse}.read();
+            auto district_addr = home.districts + district;
+            auto dist = Shared<District>{tx, district_addr}.read();
+            auto id = dist.next_order;
+            Shared<intptr_t>{tx, &district_addr->next_order} = id + 1;
+            Shared<intptr_t>{tx, &district_addr->nblines} = dist.nblines + static_cast<intptr_t>(lines.size());
+            Order order;
+            order.id       = id;
+            order.customer = static_cast<intptr_t>(customer);
+            order.nblines  = static_cast<intptr_t>(lines.size());
+            order.total    = 0;
+            for (size_t i = 0; i < lines.size(); ++i) {
+                auto line = lines[i];
+                auto price = Shared<intptr_t>{tx, db.prices + line.item}.read();
+                auto stock_addr = (line.supplier == static_cast<intptr_t>(warehouse) ? home.stocks : Shared<Warehouse>{tx, db.warehouses + line.supplier}.read().stocks) + line.item;
+                auto stock = Shared<Stock>{tx, stock_addr}.read();
+                stock.quantity = stock.quantity >= line.quantity + 10 ? stock.quantity - line.quantity : stock.quantity - line.quantity + 91; // Restocked when low
+                stock.ytd += line.quantity;
+                ++stock.order_cnt;
+                if (line.supplier != static_cast<intptr_t>(warehouse))
+                    ++stock.remote_cnt;
+                Shared<Stock>{tx, stock_addr} = stock;
+                line.amount = line.quantity * price * (10000 + home.tax + dist.tax) / 10000;
+                order.lines[i] = line;
+                order.total += line.amount;
+            }
+            auto addr = reinterpret_cast<Order*>(tx.alloc(size_of(lines.size())));
+            tx.write(&order, size_of(lines.size()), addr);
+            auto slot = &district_addr->orders[static_cast<size_t>(id) % nbrecent];
+            Order* evicted = Shared<Order*>{tx, slot};
+            if (evicted)
+                tx.free(evicted);
+            Shared<Order*>{tx, slot} = addr;
+            Shared<intptr_t>{tx, &dist.customers[customer].last_order} = id;
+            return id;
+        });
+    }
+    /** Payment transaction: add to the year-to-date amounts of the warehouse and district, and charge the customer.
+     * @param warehouse          Home warehouse
+     * @param district           District in the home warehouse
+     * @param customer_warehouse Warehouse of the customer
+     * @param customer_district  District of the customer
+     * @param customer           Paying customer in its district
+     * @param amount             Paid amount
+    **/
+    void payment(size_t warehouse, size_t district, size_t customer_warehouse, size_t customer_district, size_t customer, intptr_t amount) const {
+        TransactionalMemory::Hints hints{16, 6, STM::Hint::small};
+        transactional(tm, Transaction::Mode::read_write, hints, [&](Transaction& tx) {
+            auto db = database(tx);
+            auto home = db.warehouses + warehouse;
+            Shared<intptr_t> warehouse_ytd{tx, &home->ytd};
+            warehouse_ytd = warehouse_ytd.read() + amount;
+            auto district_addr = Shared<District*>{tx, &home->districts}.read() + district;
+            Shared<intptr_t> district_ytd{tx, &district_addr->ytd};
+            district_ytd = district_ytd.read() + amount;
+            District* districts = Shared<District*>{tx, &db.warehouses[customer_warehouse].districts};
+            auto customer_addr = Shared<Customer*>{tx, &districts[customer_district].customers}.read() + customer;
+            auto entry = Shared<Customer>{tx, customer_addr}.read();
+            entry.balance     -= amount;
+            entry.ytd_payment += amount;
+            ++entry.payment_cnt;
+            Shared<Customer>{tx, customer_addr} = entry;
+        });
+    }
+    /** Order-status transaction: read the balance of a customer and its last order, if still kept.
+     * @param warehouse Warehouse of the customer
+     * @param district  District of the customer
+     * @param customer  Customer in the district
+     * @return Number of the last order of the customer (-1 if none), none if the kept order is not consistent with the customer
+    **/
+    ::std::optional<intptr_t> order_status(size_t warehouse, size_t district, size_t customer) const {
+        TransactionalMemory::Hints hints{4 * max_lines + 16, 0, STM::Hint::small};
+        return transactional(tm, Transaction::Mode::read_only, hints, [&](Transaction& tx) -> ::std::optional<intptr_t> {
+            auto db = database(tx);
+            District* districts = Shared<District*>{tx, &db.warehouses[warehouse].districts};
+            auto district_addr = districts + district;
+            Customer* customers = Shared<Customer*>{tx, &district_addr->customers};
+            auto entry = Shared<Customer>{tx, customers + customer}.read();
+            if (entry.last_order < 0)
+                return entry.last_order;
+            Order* addr = Shared<Order*>{tx, &district_addr->orders[static_cast<size_t>(entry.last_order) % nbrecent]};
+            if (unlikely(!addr))
+                return ::std::nullopt;
+            auto id = Shared<intptr_t>{tx, &addr->id}.read();
+            if (id != entry.last_order) // Evicted by more recent orders
+                return entry.last_order;
+            Order order;
+            tx.read(addr, offsetof(Order, lines), &order);
+            if (unlikely(order.customer != static_cast<intptr_t>(customer) || order.nblines < static_cast<intptr_t>(min_lines) || order.nblines > static_cast<intptr_t>(max_lines)))
+                return ::std::nullopt;
+            tx.read(addr->lines, static_cast<size_t>(order.nblines) * sizeof(OrderLine), order.lines);
+            intptr_t total = 0;
+            for (intptr_t i = 0; i < order.nblines; ++i)
+                total += order.lines[i].amount;
+            if (unlikely(total != order.total))
+                return ::std::nullopt;
+            return entry.last_order;
+        });
+    }
+    /** Draw the lines of a new order: 1% of the items are supplied by another warehouse (if any).
+     * @param engine    Random engine
+     * @param items     Item sampler
+     * @param warehouse Home warehouse
+     * @param lines     Drawn lines (overwritten)
+    **/
+    template<class Engine> void draw(Engine& engine, AccessPattern::Sampler& items, size_t warehouse, ::std::vector<OrderLine>& lines) const {
+        ::std::uniform_int_distribution<size_t> nblines_dist{min_lines, max_lines};
+        ::std::uniform_int_distribution<intptr_t> quantity_dist{1, 10};
+        ::std::bernoulli_distribution remote_dist{nbwarehouses > 1 ? 0.01 : 0.};
+        ::std::uniform_int_distribution<size_t> warehouse_dist{0, nbwarehouses - 1};
+        lines.resize(nblines_dist(engine));
+        for (auto&& line: lines) {
+            auto supplier = remote_dist(engine) ? warehouse_dist(engine) : warehouse;
+            line = OrderLine{static_cast<intptr_t>(items(engine)), static_cast<intptr_t>(supplier), quantity_dist(engine), 0};
+        }
+    }
+    /** Check the consistency conditions: the year-to-date amount of each warehouse is the sum of its districts', these sum to the payments of the customers,
+     * each customer's balance reflects its payments, the order lines of the districts match the order counts of the stocks, and the kept orders are the last ones.
+     * @return Constant null-terminated error message, 'nullptr' for none
+    **/
+    char const* verify() const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            auto db = database(tx);
+            intptr_t districts_ytd = 0;
+            intptr_t customers_ytd = 0;
+            intptr_t districts_lines = 0;
+            intptr_t stocks_lines = 0;
+            for (size_t w = 0; w < nbwarehouses; ++w) {
+                auto warehouse = Shared<Warehouse>{tx, db.warehouses + w}.read();
+                intptr_t ytd = 0;
+                for (size_t d = 0; d < nbdistricts; ++d) {
+                    auto district = Shared<District>{tx, warehouse.districts + d}.read();
+                    ytd += district.ytd;
+                    districts_lines += district.nblines;
+                    for (size_t c = 0; c < nbcustomers; ++c) {
+                        auto customer = Shared<Customer>{tx, district.customers + c}.read();
+                        if (unlikely(customer.balance != -customer.ytd_payment || customer.last_order >= district.next_order))
+                            return "Violated isolation or atomicity (inconsistent customer)";
+                        customers_ytd += customer.ytd_payment;
+                    }
+                    for (size_t slot = 0; slot < nbrecent; ++slot) {
+                        auto addr = district.orders[slot];
+                        if (!addr)
+                            continue;
+                        Order order;
+                        tx.read(addr, offsetof(Order, lines), &order);
+                        if (unlikely(static_cast<size_t>(order.id) % nbrecent != slot || order.id >= district.next_order || order.id + static_cast<intptr_t>(nbrecent) < district.next_order || order.customer < 0 || static_cast<size_t>(order.customer) >= nbcustomers))
+                            return "Violated isolation or atomicity (inconsistent order)";
+                    }
+                }
+                if (unlikely(ytd != warehouse.ytd))
+                    return "Violated isolation or atomicity (warehouse and district amounts differ)";
+                districts_ytd += ytd;
+                ::std::vector<Stock> stocks(nbitems);
+                Shared<Stock[]>{tx, warehouse.stocks}.read(0, nbitems, stocks.data());
+                for (auto&& stock: stocks)
+                    stocks_lines += stock.order_cnt;
+            }
+            if (unlikely(districts_ytd != customers_ytd))
+                return "Violated isolation or atomicity (district and customer payments differ)";
+            if (unlikely(districts_lines != stocks_lines))
+                return "Violated isolation or atomicity (order lines and stocks differ)";
+            return nullptr;
+        });
+    }
+public:
+    /**
+     * (Re)build the database, without any order nor payment, in a single transaction so that concurrent initializations do not mix.
+    **/
+    virtual char const* init() const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto db = database(tx);
+            if (db.warehouses) { // Free the previous database, if any
+                for (size_t w = 0; w < nbwarehouses; ++w) {
+                    auto warehouse = Shared<Warehouse>{tx, db.warehouses + w}.read();
+                    for (size_t d = 0; d < nbdistricts; ++d) {
+                        auto district = Shared<District>{tx, warehouse.districts + d}.read();
+                        for (auto order: district.orders) {
+                            if (order)
+                                tx.free(order);
+                        }
+                        tx.free(district.customers);
+                    }
+                    tx.free(warehouse.districts);
+                    tx.free(warehouse.stocks);
+                }
+                tx.free(db.warehouses);
+                tx.free(db.prices);
+            }
+            ::std::minstd_rand engine{static_cast<Seed>(nbitems)}; // Same database at every initialization
+            ::std::uniform_int_distribution<intptr_t> price_dist{100, 10000};
+            ::std::uniform_int_distribution<intptr_t> tax_dist{0, 2000};
+            ::std::uniform_int_distribution<intptr_t> quantity_dist{10, 100};
+            ::std::vector<intptr_t> prices(nbitems);
+            for (auto&& price: prices)
+                price = price_dist(engine);
+            ::std::vector<Warehouse> warehouses(nbwarehouses);
+            for (auto&& warehouse: warehouses) {
+                ::std::vector<District> districts(nbdistricts);
+                for (auto&& district: districts)
+                    district = District{0, tax_dist(engine), 0, 0, create(tx, ::std::vector<Customer>(nbcustomers, Customer{0, 0, 0, -1})), {}};
+                ::std::vector<Stock> stocks(nbitems);
+                for (auto&& stock: stocks)
+                    stock = Stock{quantity_dist(engine), 0, 0, 0};
+                warehouse = Warehouse{0, tax_dist(engine), create(tx, districts), create(tx, stocks)};
+            }
+            Shared<Database>{tx, tm.get_start()} = Database{create(tx, warehouses), create(tx, prices)};
+        });
+        return verify();
+    }
+    /**
+     * Run nbtxperwrk random transactions from the home warehouse of the worker until completion, or until the deadline when time-bounded.
+     * The mix follows the TPC-C ratios of the three transactions (45:43:4).
+     * @param seed Randomness source
+    **/
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::discrete_distribution<size_t> type_dist{45, 43, 4};
+        ::std::uniform_int_distribution<size_t> district_dist{0, nbdistricts - 1};
+        ::std::uniform_int_distribution<size_t> warehouse_dist{0, nbwarehouses - 1};
+        ::std::bernoulli_distribution remote_dist{nbwarehouses > 1 ? 0.15 : 0.};
+        ::std::uniform_int_distribution<intptr_t> amount_dist{100, 500000};
+        auto customers = access.sampler(nbcustomers);
+        auto items = access.sampler(nbitems);
+        auto const warehouse = uid % nbwarehouses;
+        ::std::vector<OrderLine> lines;
+        ::std::minstd_rand arrivals{~seed};
+        auto arrival = get_origin();
+        Chrono latency; // Latency of each transaction, including its retries (and its queueing, in open loop)
+        size_t cntr = 0;
+        for (; proceed(cntr, nbtxperwrk); ++cntr) {
+            auto district = district_dist(engine);
+            auto type = type_dist(engine);
+            if (type == tx_new_order) {
+                auto customer = customers(engine);
+                draw(engine, items, warehouse, lines);
+                Attempts::Scope accounting{attempts_of(uid, tx_new_order)};
+                pace(latency, arrivals, arrival);
+                new_order(warehouse, district, customer, lines);
+                record(uid, tx_new_order, latency.delta());
+            } else if (type == tx_payment) {
+                auto remote = remote_dist(engine); // Customer of another warehouse
+                auto customer_warehouse = remote ? warehouse_dist(engine) : warehouse;
+                auto customer_district = remote ? district_dist(engine) : district;
+                auto customer = customers(engine);
+                auto amount = amount_dist(engine);
+                Attempts::Scope accounting{attempts_of(uid, tx_payment)};
+                pace(latency, arrivals, arrival);
+                payment(warehouse, district, customer_warehouse, customer_district, customer, amount);
+                record(uid, tx_payment, latency.delta());
+            } else {
+                auto customer = customers(engine);
+                Attempts::Scope accounting{attempts_of(uid, tx_order_status)};
+                pace(latency, arrivals, arrival);
+                auto status = order_status(warehouse, district, customer);
+                record(uid, tx_order_status, latency.delta());
+                if (unlikely(!status))
+                    return "Violated isolation or atomicity (inconsistent order)";
+            }
+        }
+        complete(uid, cntr);
+        return nullptr;
+    }
+    /**
+     * Check the database after the runs, then check that concurrent new orders and payments all take effect.
+     * @param uid  Id of the thread to run the check
+     * @param seed Randomness source
+    **/
+    virtual char const* check(Uid uid, Seed seed) const {
+        constexpr size_t nbchecks = 32; // New orders (and payments) per worker
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_int_distribution<size_t> district_dist{0, nbdistricts - 1};
+        ::std::uniform_int_distribution<size_t> customer_dist{0, nbcustomers - 1};
+        auto items = AccessPattern{}.sampler(nbitems);
+        ::std::vector<OrderLine> lines;
+        return check_phases(uid, barrier, [&]() { return verify(); }, [&]() -> char const* {
+            auto const warehouse = uid % nbwarehouses;
+            for (size_t i = 0; i < nbchecks; ++i) {
+                auto district = district_dist(engine);
+                auto customer = customer_dist(engine);
+                draw(engine, items, warehouse, lines);
+                auto id = new_order(warehouse, district, customer, lines);
+                auto status = order_status(warehouse, district, customer);
+                if (unlikely(!status || *status < id)) // Later orders of the same customer may have been entered meanwhile
+                    return "Violated consistency, isolation or atomicity (lost order)";
+                payment(warehouse, district, warehouse, district, customer, 1);
+            }
+            return nullptr;
+        });
+    }
+};
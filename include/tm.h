@@ -59,3 +59,58 @@ bool     tm_read(shared_t, tx_t, void const*, size_t, void*);
 bool     tm_write(shared_t, tx_t, void const*, size_t, void*);
 alloc_t  tm_alloc(shared_t, tx_t, size_t, void**);
 bool     tm_free(shared_t, tx_t, void*);
+
+// -------------------------------------------------------------------------- //
+// Optional entry points: a library may leave any of them undefined, callers
+// resolve them at runtime and fall back on the interface above when missing.
+// Inside a nested scope, an operation that fails does not end the transaction:
+// the caller calls 'tm_rollback_nested', which tells whether the transaction
+// can go on (e.g. to retry the scope) or has been aborted as a whole.
+
+/** Statistics of a shared memory region, cumulated since its creation.
+**/
+struct tm_stats {
+    uint64_t commits;      // Committed transactions
+    uint64_t aborts_read;  // Transactions aborted by a failed read validation
+    uint64_t aborts_write; // Transactions aborted by a conflict on a written location (e.g. a lock already held)
+    uint64_t aborts_alloc; // Transactions aborted by a memory allocation/freeing
+    uint64_t commit_time;  // Total time spent committing transactions (in ns)
+};
+
+/** Access in a batched read/write operation.
+**/
+struct tm_access {
+    void const* source; // Source start address (in the shared region for reads, in a private region for writes)
+    size_t      size;   // Length to copy (in bytes), must be a positive multiple of the alignment
+    void*       target; // Target start address (in a private region for reads, in the shared region for writes)
+};
+
+typedef int add_t;
+static add_t const success_add = 0; // Delta applied and the TX can continue
+static add_t const abort_add   = 1; // TX was aborted and could be retried
+static add_t const bound_add   = 2; // Delta not applied as the result would go below the floor, but TX was not aborted
+
+typedef int hint_t;
+static hint_t const any_hint   = 0; // No particular shape
+static hint_t const small_hint = 1; // Few accesses (e.g. a transfer between two accounts)
+static hint_t const scan_hint  = 2; // Many reads over a large part of the region
+
+/** Expected footprint of a transaction, given when it begins.
+**/
+struct tm_hints {
+    size_t reads;  // Expected number of reads
+    size_t writes; // Expected number of writes
+    hint_t shape;  // Expected shape of the transaction
+};
+
+shared_t tm_create_durable(size_t, size_t, char const*);
+bool     tm_checkpoint(shared_t, char const*);
+shared_t tm_restore(char const*);
+bool     tm_stats(shared_t, struct tm_stats*);
+bool     tm_readv(shared_t, tx_t, struct tm_access const*, size_t);
+bool     tm_writev(shared_t, tx_t, struct tm_access const*, size_t);
+add_t    tm_add(shared_t, tx_t, void*, intptr_t, intptr_t);
+bool     tm_begin_nested(shared_t, tx_t);
+bool     tm_end_nested(shared_t, tx_t);
+bool     tm_rollback_nested(shared_t, tx_t);
+tx_t     tm_begin_ext(shared_t, bool, struct tm_hints const*);
@@ -61,3 +61,62 @@ extern "C" {
     Alloc    tm_alloc(shared_t, tx_t, size_t, void**) noexcept;
     bool     tm_free(shared_t, tx_t, void*) noexcept;
 }
+
+// -------------------------------------------------------------------------- //
+// Optional entry points: a library may leave any of them undefined, callers
+// resolve them at runtime and fall back on the interface above when missing.
+// Inside a nested scope, an operation that fails does not end the transaction:
+// the caller calls 'tm_rollback_nested', which tells whether the transaction
+// can go on (e.g. to retry the scope) or has been aborted as a whole.
+
+/** Statistics of a shared memory region, cumulated since its creation.
+**/
+struct tm_stats {
+    uint64_t commits;      // Committed transactions
+    uint64_t aborts_read;  // Transactions aborted by a failed read validation
+    uint64_t aborts_write; // Transactions aborted by a conflict on a written location (e.g. a lock already held)
+    uint64_t aborts_alloc; // Transactions aborted by a memory allocation/freeing
+    uint64_t commit_time;  // Total time spent committing transactions (in ns)
+};
+
+/** Access in a batched read/write operation.
+**/
+struct tm_access {
+    void const* source; // Source start address (in the shared region for reads, in a private region for writes)
+    size_t      size;   // Length to copy (in bytes), must be a positive multiple of the alignment
+    void*       target; // Target start address (in a private region for reads, in the shared region for writes)
+};
+
+enum class Add: int {
+    success = 0, // Delta applied and the TX can continue
+    abort   = 1, // TX was aborted and could be retried
+    bound   = 2  // Delta not applied as the result would go below the floor, but TX was not aborted
+};
+
+enum class Hint: int {
+    any   = 0, // No particular shape
+    small = 1, // Few accesses (e.g. a transfer between two accounts)
+    scan  = 2  // Many reads over a large part of the region
+};
+
+/** Expected footprint of a transaction, given when it begins.
+**/
+struct tm_hints {
+    size_t reads;  // Expected number of reads
+    size_t writes; // Expected number of writes
+    Hint   shape;  // Expected shape of the transaction
+};
+
+extern "C" {
+    shared_t tm_create_durable(size_t, size_t, char const*) noexcept;
+    bool     tm_checkpoint(shared_t, char const*) noexcept;
+    shared_t tm_restore(char const*) noexcept;
+    bool     tm_stats(shared_t, struct tm_stats*) noexcept;
+    bool     tm_readv(shared_t, tx_t, struct tm_access const*, size_t) noexcept;
+    bool     tm_writev(shared_t, tx_t, struct tm_access const*, size_t) noexcept;
+    Add      tm_add(shared_t, tx_t, void*, intptr_t, intptr_t) noexcept;
+    bool     tm_begin_nested(shared_t, tx_t) noexcept;
+    bool     tm_end_nested(shared_t, tx_t) noexcept;
+    bool     tm_rollback_nested(shared_t, tx_t) noexcept;
+    tx_t     tm_begin_ext(shared_t, bool, struct tm_hints const*) noexcept;
+}
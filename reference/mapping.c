@@ -0,0 +1,99 @@
+// Requested feature: MAP_ANONYMOUS, madvise
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "macros.h"
+#include "mapping.h"
+
+size_t mapping_page_size(void) {
+    static size_t page_size = 0;
+    if (unlikely(page_size == 0)) {
+        long res = sysconf(_SC_PAGESIZE);
+        page_size = res > 0 ? (size_t) res : 4096;
+    }
+    return page_size;
+}
+
+/** Round the given size up to a multiple of the given power of 2.
+ * @param size  Size to round up
+ * @param align Power of 2
+ * @return Rounded size
+**/
+static size_t round_up(size_t size, size_t align) {
+    return (size + align - 1) & ~(align - 1);
+}
+
+void* mapping_create(size_t size) {
+    size = round_up(size, mapping_page_size());
+    if (size < MAPPING_HUGE_PAGE) {
+        void* start = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return start == MAP_FAILED ? NULL : start;
+    }
+    // We over-reserve by one huge page, then trim both ends so that the range
+    // starts on a huge page boundary (the kernel only backs aligned ranges
+    // with huge pages).
+    size_t reserved = size + MAPPING_HUGE_PAGE;
+    void* base = mmap(NULL, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (unlikely(base == MAP_FAILED))
+        return NULL;
+    uintptr_t start = round_up((uintptr_t) base, MAPPING_HUGE_PAGE);
+    size_t head = start - (uintptr_t) base;
+    size_t tail = reserved - head - size;
+    if (head > 0)
+        munmap(base, head);
+    if (tail > 0)
+        munmap((void*) (start + size), tail);
+#if defined(MADV_HUGEPAGE) && !defined(NO_MADV_HUGEPAGE)
+    madvise((void*) start, size, MADV_HUGEPAGE); // Only an advice: failure (e.g. THP disabled) is harmless
+#endif
+    return (void*) start;
+}
+
+/** Map a range at a given address, either zero-filled or as a private view of a file.
+ * @param start  Page-aligned address at which to map the range
+ * @param size   Size of the range (in bytes, multiple of the page size)
+ * @param fd     File to map, -1 for a zero-filled range
+ * @param offset Page-aligned offset of the range in the file
+ * @return Whether the range is now mapped at the given address
+**/
+static bool map_at(void* start, size_t size, int fd, off_t offset) {
+#ifdef MAP_FIXED_NOREPLACE
+    int flags = MAP_PRIVATE | MAP_FIXED_NOREPLACE;
+#else
+    int flags = MAP_PRIVATE; // The address is then only a hint
+#endif
+    if (fd < 0)
+        flags |= MAP_ANONYMOUS;
+    void* res = mmap(start, size, PROT_READ | PROT_WRITE, flags, fd, offset);
+    if (unlikely(res == MAP_FAILED))
+        return false;
+    if (unlikely(res != start)) { // Kernels ignoring MAP_FIXED_NOREPLACE map elsewhere instead of failing
+        munmap(res, size);
+        return false;
+    }
+    return true;
+}
+
+bool mapping_create_at(void* start, size_t size) {
+    size = round_up(size, mapping_page_size());
+    if (unlikely(!map_at(start, size, -1, 0)))
+        return false;
+#if defined(MADV_HUGEPAGE) && !defined(NO_MADV_HUGEPAGE)
+    if (size >= MAPPING_HUGE_PAGE && (uintptr_t) start % MAPPING_HUGE_PAGE == 0)
+        madvise(start, size, MADV_HUGEPAGE);
+#endif
+    return true;
+}
+
+bool mapping_load_at(void* start, size_t size, int fd, uint64_t offset) {
+    return map_at(start, round_up(size, mapping_page_size()), fd, (off_t) offset);
+}
+
+void mapping_destroy(void* start, size_t size) {
+    munmap(start, round_up(size, mapping_page_size()));
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Size (in bytes) from which a segment is worth a dedicated mapping rather
+ *  than a heap allocation followed by a 'memset'.
+**/
+#define MAPPING_THRESHOLD ((size_t) 128 * 1024)
+
+/** Size (in bytes) of a transparent huge page on the platforms we target.
+**/
+#define MAPPING_HUGE_PAGE ((size_t) 2 * 1024 * 1024)
+
+/** Map a fresh, zero-filled memory range. The kernel provides the zero pages
+ *  lazily, so the cost does not depend on the requested size. Ranges of at
+ *  least one huge page are aligned on a huge page boundary and advised as
+ *  eligible for transparent huge pages (unless 'NO_MADV_HUGEPAGE' is defined).
+ * @param size Size of the range (in bytes, non-null)
+ * @return Start address of the range (aligned on at least a page), NULL on failure
+**/
+void* mapping_create(size_t size);
+
+/** Map a fresh, zero-filled memory range at a given address, which must not
+ *  overlap any existing mapping. Used to rebuild a region at the addresses it
+ *  had in a previous process.
+ * @param start Page-aligned address at which to map the range
+ * @param size  Size of the range (in bytes, non-null)
+ * @return Whether the range is now mapped at the given address
+**/
+bool mapping_create_at(void* start, size_t size);
+
+/** Map a private, copy-on-write view of a file range at a given address, which
+ *  must not overlap any existing mapping. Pages are read from the file lazily,
+ *  on first touch, and modifications are never written back to the file.
+ * @param start  Page-aligned address at which to map the range
+ * @param size   Size of the range (in bytes, non-null)
+ * @param fd     File to map (opened for reading)
+ * @param offset Page-aligned offset of the range in the file
+ * @return Whether the range is now mapped at the given address
+**/
+bool mapping_load_at(void* start, size_t size, int fd, uint64_t offset);
+
+/** Unmap a range previously obtained from 'mapping_create', 'mapping_create_at' or 'mapping_load_at'.
+ * @param start Start address of the range
+ * @param size  Size of the range, as given when mapping it
+**/
+void mapping_destroy(void* start, size_t size);
+
+/** Get the size of a page, which bounds the alignment a mapping guarantees.
+ * @return Page size (in bytes)
+**/
+size_t mapping_page_size(void);
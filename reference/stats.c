@@ -0,0 +1,73 @@
+// Requested feature: clock_gettime
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+
+#include "macros.h"
+#include "stats.h"
+
+/** Get the stripe of the calling thread, assigned on its first call.
+ * @param stats Counters to update
+ * @return Stripe of the calling thread
+**/
+static struct stats_stripe_t* stats_stripe(struct stats_t* stats) {
+    static atomic_uint next_id = 0;
+    static _Thread_local unsigned int id = STATS_STRIPES; // Not assigned yet
+    if (unlikely(id == STATS_STRIPES))
+        id = atomic_fetch_add_explicit(&next_id, 1, memory_order_relaxed) % STATS_STRIPES;
+    return stats->stripes + id;
+}
+
+void stats_init(struct stats_t* stats) {
+    for (size_t i = 0; i < STATS_STRIPES; ++i) {
+        struct stats_stripe_t* stripe = stats->stripes + i;
+        atomic_init(&(stripe->commits), 0);
+        atomic_init(&(stripe->aborts_read), 0);
+        atomic_init(&(stripe->aborts_write), 0);
+        atomic_init(&(stripe->aborts_alloc), 0);
+        atomic_init(&(stripe->commit_time), 0);
+    }
+}
+
+uint64_t stats_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+void stats_commit(struct stats_t* stats, uint64_t start) {
+    struct stats_stripe_t* stripe = stats_stripe(stats);
+    atomic_fetch_add_explicit(&(stripe->commits), 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&(stripe->commit_time), stats_now() - start, memory_order_relaxed);
+}
+
+void stats_abort(struct stats_t* stats, enum stats_abort cause) {
+    struct stats_stripe_t* stripe = stats_stripe(stats);
+    switch (cause) {
+    case stats_abort_read:
+        atomic_fetch_add_explicit(&(stripe->aborts_read), 1, memory_order_relaxed);
+        break;
+    case stats_abort_write:
+        atomic_fetch_add_explicit(&(stripe->aborts_write), 1, memory_order_relaxed);
+        break;
+    case stats_abort_alloc:
+        atomic_fetch_add_explicit(&(stripe->aborts_alloc), 1, memory_order_relaxed);
+        break;
+    }
+}
+
+void stats_collect(struct stats_t* stats, struct tm_stats* res) {
+    res->commits      = 0;
+    res->aborts_read  = 0;
+    res->aborts_write = 0;
+    res->aborts_alloc = 0;
+    res->commit_time  = 0;
+    for (size_t i = 0; i < STATS_STRIPES; ++i) {
+        struct stats_stripe_t* stripe = stats->stripes + i;
+        res->commits      += atomic_load_explicit(&(stripe->commits), memory_order_relaxed);
+        res->aborts_read  += atomic_load_explicit(&(stripe->aborts_read), memory_order_relaxed);
+        res->aborts_write += atomic_load_explicit(&(stripe->aborts_write), memory_order_relaxed);
+        res->aborts_alloc += atomic_load_explicit(&(stripe->aborts_alloc), memory_order_relaxed);
+        res->commit_time  += atomic_load_explicit(&(stripe->commit_time), memory_order_relaxed);
+    }
+}
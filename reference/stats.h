@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include <tm.h>
+
+/** Number of stripes the counters are spread over.
+**/
+#define STATS_STRIPES 64
+
+/**
+ * @brief One stripe of counters, aligned on (hence alone in) a cache line.
+ * The structure embedding the counters must be allocated with that alignment.
+ */
+struct stats_stripe_t {
+    _Alignas(64) _Atomic(uint64_t) commits;
+    _Atomic(uint64_t) aborts_read;
+    _Atomic(uint64_t) aborts_write;
+    _Atomic(uint64_t) aborts_alloc;
+    _Atomic(uint64_t) commit_time;
+};
+
+/**
+ * @brief Transaction counters of a region. Each thread updates its own
+ * stripe, so that concurrent transactions do not contend on the counters.
+ */
+struct stats_t {
+    struct stats_stripe_t stripes[STATS_STRIPES];
+};
+
+/** Abort causes.
+**/
+enum stats_abort {
+    stats_abort_read,  // Failed read validation
+    stats_abort_write, // Conflict on a written location
+    stats_abort_alloc  // Memory allocation/freeing
+};
+
+/** Reset the given counters.
+ * @param stats Counters to reset
+**/
+void stats_init(struct stats_t* stats);
+
+/** Get the current time, to later measure the duration of a commit.
+ * @return Current time (in ns)
+**/
+uint64_t stats_now(void);
+
+/** [thread-safe] Count a committed transaction.
+ * @param stats Counters to update
+ * @param start Time at which the commit started, from 'stats_now'
+**/
+void stats_commit(struct stats_t* stats, uint64_t start);
+
+/** [thread-safe] Count an aborted transaction.
+ * @param stats Counters to update
+ * @param cause Cause of the abort
+**/
+void stats_abort(struct stats_t* stats, enum stats_abort cause);
+
+/** [thread-safe] Sum the stripes of the given counters.
+ * @param stats Counters to sum
+ * @param res   Sums of the counters
+**/
+void stats_collect(struct stats_t* stats, struct tm_stats* res);
@@ -22,22 +22,62 @@
  * Lock-based transaction manager implementation used as the reference.
 **/
 
-// Requested feature: posix_memalign
+// Requested features: posix_memalign, fdatasync, fork
+#define _GNU_SOURCE
 #define _POSIX_C_SOURCE   200809L
 
 // External headers
+#include <errno.h>
+#include <fcntl.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // Internal headers
 #include <tm.h>
 
 #include "macros.h"
+#include "mapping.h"
 #include "shared-lock.h"
+#include "stats.h"
+#include "wal.h"
 
-static const tx_t read_only_tx  = UINTPTR_MAX - 10;
-static const tx_t read_write_tx = UINTPTR_MAX - 11;
+/**
+ * @brief Descriptor of a transaction. A thread runs at most one transaction at
+ * a time, so each thread keeps its own descriptor and hands out its address.
+ */
+struct transaction {
+    bool exclusive;   // Whether the lock is held exclusively (read-write transaction, or read-only one upgraded by a modification)
+    bool modified;    // Whether the transaction modified the region (write, addition, allocation or freeing)
+    bool aborted;     // Whether the transaction was aborted inside a nested scope (reported by 'tm_rollback_nested')
+    uint64_t version; // Version of the region when the transaction began
+    size_t depth;     // Number of open nested scopes
+    uint8_t* undo;    // Undo log of the nested scopes, NULL until the first scope opens
+    size_t undo_len;  // Used size of the undo log (in bytes)
+    size_t undo_cap;  // Capacity of the undo log (in bytes)
+};
+static _Thread_local struct transaction transaction;
+
+/**
+ * @brief Entry in the undo log of a transaction, preceded by 'size' bytes of
+ * overwritten data for writes. The log is popped from its end on rollback,
+ * hence the header comes last.
+ */
+struct undo_entry {
+    uint64_t kind; // One of the 'undo_*' kinds below
+    void* address; // Written address, or node of the (de)allocated segment
+    size_t size;   // Written size (in bytes), or size of the redo record when the scope opened
+};
+static uint64_t const undo_scope  = 1; // Savepoint of an open nested scope
+static uint64_t const undo_merged = 2; // Savepoint of a closed nested scope, merged into its parent
+static uint64_t const undo_write  = 3;
+static uint64_t const undo_alloc  = 4;
+static uint64_t const undo_free   = 5; // Segment unlinked, released only when the outermost scope closes
 
 /**
  * @brief List of dynamically allocated segments.
@@ -45,9 +85,21 @@ static const tx_t read_write_tx = UINTPTR_MAX - 11;
 struct segment_node {
     struct segment_node* prev;
     struct segment_node* next;
-    // uint8_t segment[] // segment of dynamic size
+    size_t mapped; // Size of the backing mapping (in bytes), 0 if allocated with posix_memalign, 'segment_restored' if part of a checkpoint image
+    size_t size;   // Size of the segment (in bytes)
+    // uint8_t segment[] // segment of dynamic size, starting 'segment_header' bytes after the node
 };
 typedef struct segment_node* segment_list;
+static size_t const segment_restored = SIZE_MAX;
+
+/**
+ * @brief Range of a checkpoint image file mapped at the address it was taken from.
+ */
+struct checkpoint_chunk {
+    uint64_t address; // Page-aligned address of the range
+    uint64_t length;  // Size of the range (in bytes, multiple of the page size)
+    uint64_t offset;  // Offset of the range in the image file (multiple of the page size)
+};
 
 /**
  * @brief Simple Shared Memory Region (a.k.a Transactional Memory).
@@ -58,28 +110,639 @@ struct region {
     segment_list allocs; // Shared memory segments dynamically allocated via tm_alloc within transactions
     size_t size;        // Size of the non-deallocable memory segment (in bytes)
     size_t align;       // Size of a word in the shared memory region (in bytes)
+    bool start_mapped;  // Whether the non-deallocable memory segment is a mapping (or was allocated with posix_memalign)
+    struct wal_t* wal;  // Log of the committed transactions, NULL if the region is not durable
+    uint8_t* redo;      // Log record being built by the running read-write transaction (durable region only)
+    size_t redo_len;    // Used size of the record being built (in bytes)
+    size_t redo_cap;    // Capacity of the record buffer (in bytes)
+    uint64_t committed; // Log position after the last committed read-write transaction (durable region only)
+    struct checkpoint_chunk* chunks; // Mappings of the image the region was restored from, NULL if not restored
+    size_t nchunks;     // Number of such mappings
+    uint64_t version;   // Number of committed transactions that modified the region (written with the lock held exclusively)
+    struct stats_t stats; // Transaction counters
 };
 
-shared_t tm_create(size_t size, size_t align) {
-    struct region* region = (struct region*) malloc(sizeof(struct region));
+/**
+ * @brief Header of the log file of a durable region. The region is rebuilt at
+ * the very same addresses, so that the pointers stored in it stay valid.
+ */
+struct log_header {
+    char magic[8];  // 'log_magic'
+    uint64_t start; // Address of the non-deallocable memory segment
+    uint64_t size;  // Size of the non-deallocable memory segment (in bytes)
+    uint64_t align; // Alignment of the region (in bytes)
+};
+static char const log_magic[8] = "TMWAL001";
+
+/**
+ * @brief Header of the log record of a committed read-write transaction,
+ * followed by its entries.
+ */
+struct log_record {
+    uint64_t length;   // Size of the entries (in bytes)
+    uint64_t checksum; // Checksum of the entries, to detect a torn record at the end of the log
+};
+
+/**
+ * @brief Entry in a log record, followed by 'size' bytes of data for writes.
+ */
+struct log_entry {
+    uint64_t kind;    // One of the 'log_*' kinds below
+    uint64_t address; // Written address, or address of the (de)allocated segment
+    uint64_t size;    // Written size, or size of the allocated segment (in bytes)
+};
+static uint64_t const log_write = 1;
+static uint64_t const log_alloc = 2;
+static uint64_t const log_free  = 3;
+
+/**
+ * @brief Header of a checkpoint image file, followed by the table of its
+ * chunks, then by the page-aligned content of each chunk. A chunk is a range of
+ * pages covering one or more segments, which is mapped back at the very same
+ * address on restore.
+ */
+struct checkpoint_header {
+    char magic[8];    // 'checkpoint_magic'
+    uint64_t start;   // Address of the non-deallocable memory segment
+    uint64_t size;    // Size of the non-deallocable memory segment (in bytes)
+    uint64_t align;   // Alignment of the region (in bytes)
+    uint64_t allocs;  // Address of the node of the first dynamically allocated segment, 0 for none
+    uint64_t nchunks; // Number of chunks
+};
+static char const checkpoint_magic[8] = "TMCKP001";
+
+/** Get the space reserved in front of each dynamically allocated segment.
+ * @param align Alignment of the shared memory region
+ * @return Size of the segment header (in bytes), a multiple of the alignment
+**/
+static size_t segment_header(size_t align) {
+    return (sizeof(struct segment_node) + align - 1) & ~(align - 1);
+}
+
+/** Allocate and initialize the descriptor of a region, without its first segment.
+ * @param size  Size of the first segment (in bytes)
+ * @param align Alignment of the region (in bytes)
+ * @return Region descriptor, NULL on failure
+**/
+static struct region* region_alloc(size_t size, size_t align) {
+    // The alignment of the counter stripes keeps each of them in its own cache line
+    struct region* region = (struct region*) aligned_alloc(_Alignof(struct region), sizeof(struct region));
     if (unlikely(!region)) {
-        return invalid_shared;
+        return NULL;
     }
-    // We allocate the shared memory buffer such that its words are correctly
-    // aligned.
-    if (posix_memalign(&(region->start), align, size) != 0) {
+    if (!shared_lock_init(&(region->lock))) {
         free(region);
+        return NULL;
+    }
+    region->start        = NULL;
+    region->allocs       = NULL;
+    region->size         = size;
+    region->align        = align;
+    region->start_mapped = false;
+    region->wal          = NULL;
+    region->redo         = NULL;
+    region->redo_len     = 0;
+    region->redo_cap     = 0;
+    region->committed    = 0;
+    region->chunks       = NULL;
+    region->nchunks      = 0;
+    region->version      = 0;
+    stats_init(&(region->stats));
+    return region;
+}
+
+/** Create a region, possibly with its first segment at a given address.
+ * @param size  Size of the first segment (in bytes)
+ * @param align Alignment of the region (in bytes)
+ * @param start Address at which to map the first segment, NULL for any
+ * @return Created region, NULL on failure
+**/
+static struct region* region_create(size_t size, size_t align, void* start) {
+    struct region* region = region_alloc(size, align);
+    if (unlikely(!region)) {
+        return NULL;
+    }
+    // We map the first segment directly: mappings are page-aligned and the
+    // kernel zero-fills their pages on first touch, so creating a region does
+    // not cost more for a larger segment. Alignments beyond a page fall back to
+    // an aligned heap allocation.
+    region->start_mapped = align <= mapping_page_size();
+    if (start) {
+        if (unlikely(!region->start_mapped || !mapping_create_at(start, size))) {
+            shared_lock_cleanup(&(region->lock));
+            free(region);
+            return NULL;
+        }
+        region->start = start;
+    } else if (region->start_mapped) {
+        region->start = mapping_create(size);
+        if (unlikely(!region->start)) {
+            shared_lock_cleanup(&(region->lock));
+            free(region);
+            return NULL;
+        }
+    } else {
+        if (posix_memalign(&(region->start), align, size) != 0) {
+            shared_lock_cleanup(&(region->lock));
+            free(region);
+            return NULL;
+        }
+        memset(region->start, 0, size);
+    }
+    return region;
+}
+
+shared_t tm_create(size_t size, size_t align) {
+    struct region* region = region_create(size, align, NULL);
+    if (unlikely(!region))
+        return invalid_shared;
+    return region;
+}
+
+/** Get the alignment of the dynamically allocated segments of a region.
+ * @param region Region to query
+ * @return Alignment of the segments (in bytes)
+**/
+static size_t segment_align(struct region const* region) {
+    // The alignment of the 'next' and 'prev' pointers must be satisfied as
+    // well, thus we use max(align, struct segment_node*).
+    return region->align < sizeof(struct segment_node*) ? sizeof(void*) : region->align;
+}
+
+/** Insert a segment at the head of the list of dynamically allocated segments.
+ * @param region Region owning the segment
+ * @param sn     Node of the segment to insert
+**/
+static void segment_link(struct region* region, struct segment_node* sn) {
+    sn->prev = NULL;
+    sn->next = region->allocs;
+    if (sn->next) sn->next->prev = sn;
+    region->allocs = sn;
+}
+
+/** Remove a segment from the list of dynamically allocated segments.
+ * @param region Region owning the segment
+ * @param sn     Node of the segment to remove
+**/
+static void segment_unlink(struct region* region, struct segment_node* sn) {
+    if (sn->prev) sn->prev->next = sn->next;
+    else region->allocs = sn->next;
+    if (sn->next) sn->next->prev = sn->prev;
+}
+
+/** Release the memory backing a dynamically allocated segment.
+ * @param sn Node of the segment to release
+**/
+static void segment_release(struct segment_node* sn) {
+    if (sn->mapped == segment_restored) // Released with the whole image
+        return;
+    if (sn->mapped > 0)
+        mapping_destroy(sn, sn->mapped);
+    else
+        free(sn);
+}
+
+/** Compute the checksum of a log record's entries (64-bit FNV-1a).
+ * @param data Entries of the record
+ * @param size Size of the entries (in bytes)
+ * @return Checksum
+**/
+static uint64_t log_checksum(uint8_t const* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+/** Make room in the log record of the running read-write transaction.
+ * @param region Durable region
+ * @param length Size to make room for, after what the record already holds (in bytes)
+ * @return Whether the record can hold that much more
+**/
+static bool redo_reserve(struct region* region, size_t length) {
+    if (likely(region->redo_len + length <= region->redo_cap))
+        return true;
+    size_t cap = region->redo_cap;
+    while (cap < region->redo_len + length)
+        cap *= 2;
+    uint8_t* redo = (uint8_t*) realloc(region->redo, cap);
+    if (unlikely(!redo))
+        return false;
+    region->redo     = redo;
+    region->redo_cap = cap;
+    return true;
+}
+
+/** Append an entry to the log record of the running read-write transaction.
+ *  If the record cannot grow, the log is marked as failed: the transaction
+ *  still takes effect in memory, but the region stops accepting new ones.
+ * @param region  Durable region
+ * @param kind    Kind of the entry
+ * @param address Written address, or address of the (de)allocated segment
+ * @param size    Written size, or size of the allocated segment (in bytes)
+ * @param data    Written data (for writes only)
+**/
+static void redo_append(struct region* region, uint64_t kind, void const* address, size_t size, void const* data) {
+    size_t length = sizeof(struct log_entry) + (kind == log_write ? size : 0);
+    if (unlikely(!redo_reserve(region, length))) {
+        wal_fail(region->wal);
+        return;
+    }
+    struct log_entry entry = { kind, (uint64_t) (uintptr_t) address, size };
+    memcpy(region->redo + region->redo_len, &entry, sizeof(entry));
+    if (kind == log_write)
+        memcpy(region->redo + region->redo_len + sizeof(entry), data, size);
+    region->redo_len += length;
+}
+
+/** Hand the log record of the running read-write transaction to the log.
+ * @param region Durable region
+ * @return Log position to wait for for the transaction to be durable
+**/
+static uint64_t redo_commit(struct region* region) {
+    if (region->redo_len > sizeof(struct log_record)) { // Transactions that wrote nothing are not logged
+        struct log_record record;
+        record.length   = region->redo_len - sizeof(record);
+        record.checksum = log_checksum(region->redo + sizeof(record), record.length);
+        memcpy(region->redo, &record, sizeof(record));
+        uint64_t position = wal_append(region->wal, region->redo, region->redo_len);
+        if (likely(position > 0))
+            region->committed = position;
+        region->redo_len = sizeof(record);
+    }
+    return region->committed;
+}
+
+/** Apply the entries of a committed log record to a region being rebuilt.
+ * @param region  Region to update
+ * @param entries Entries of the record
+ * @param length  Size of the entries (in bytes)
+ * @return Whether the entries are consistent with the region
+**/
+static bool log_apply(struct region* region, uint8_t const* entries, uint64_t length) {
+    size_t header = segment_header(segment_align(region));
+    uint64_t offset = 0;
+    while (offset < length) {
+        struct log_entry entry;
+        if (unlikely(length - offset < sizeof(entry)))
+            return false;
+        memcpy(&entry, entries + offset, sizeof(entry));
+        offset += sizeof(entry);
+        if (entry.kind == log_write) {
+            if (unlikely(length - offset < entry.size))
+                return false;
+            memcpy((void*) (uintptr_t) entry.address, entries + offset, entry.size);
+            offset += entry.size;
+        } else if (entry.kind == log_alloc) {
+            struct segment_node* sn = (struct segment_node*) (uintptr_t) (entry.address - header);
+            if (unlikely(!mapping_create_at(sn, header + entry.size)))
+                return false;
+            sn->mapped = header + entry.size;
+            sn->size   = entry.size;
+            segment_link(region, sn);
+        } else if (entry.kind == log_free) {
+            struct segment_node* sn = region->allocs;
+            while (sn && (uintptr_t) sn + header != entry.address)
+                sn = sn->next;
+            if (unlikely(!sn))
+                return false;
+            segment_unlink(region, sn);
+            segment_release(sn);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Rebuild a region by replaying the committed transactions of its log.
+ *  A torn record at the end of the log (crash during a write) is discarded.
+ * @param fd       Log file
+ * @param length   Size of the log file (in bytes)
+ * @param size     Expected size of the first segment (in bytes)
+ * @param align    Expected alignment of the region (in bytes)
+ * @param position Set to the end of the valid content of the log
+ * @return Rebuilt region, NULL on failure
+**/
+static struct region* log_replay(int fd, size_t length, size_t size, size_t align, uint64_t* position) {
+    uint8_t const* log = (uint8_t const*) mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (unlikely(log == MAP_FAILED))
+        return NULL;
+    struct log_header header;
+    struct region* region = NULL;
+    if (length < sizeof(header))
+        goto unmap;
+    memcpy(&header, log, sizeof(header));
+    if (memcmp(header.magic, log_magic, sizeof(log_magic)) != 0 || header.size != size || header.align != align)
+        goto unmap;
+    region = region_create(size, align, (void*) (uintptr_t) header.start);
+    if (unlikely(!region))
+        goto unmap;
+    size_t offset = sizeof(header);
+    while (length - offset >= sizeof(struct log_record)) {
+        struct log_record record;
+        memcpy(&record, log + offset, sizeof(record));
+        uint8_t const* entries = log + offset + sizeof(record);
+        if (record.length > length - offset - sizeof(record) || log_checksum(entries, record.length) != record.checksum)
+            break; // Torn record
+        if (unlikely(!log_apply(region, entries, record.length))) {
+            tm_destroy(region);
+            region = NULL;
+            goto unmap;
+        }
+        offset += sizeof(record) + record.length;
+    }
+    if (unlikely(ftruncate(fd, offset) != 0 || lseek(fd, offset, SEEK_SET) < 0)) {
+        tm_destroy(region);
+        region = NULL;
+        goto unmap;
+    }
+    *position = offset;
+unmap:
+    munmap((void*) log, length);
+    return region;
+}
+
+/** Create a durable shared memory region, whose committed transactions are
+ *  logged in the given file. If the file already holds a log, the region is
+ *  rebuilt from it (the size and alignment must then match the logged ones).
+ * @param size  Size of the first shared segment of memory to allocate (in bytes)
+ * @param align Alignment (in bytes) that the shared memory region must support
+ * @param path  Path to the log file
+ * @return Opaque shared memory region handle, 'invalid_shared' on failure
+**/
+shared_t tm_create_durable(size_t size, size_t align, char const* path) {
+    // Every segment of a durable region is a mapping, so that it can be
+    // rebuilt at the same address.
+    if (align > mapping_page_size())
+        return invalid_shared;
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (unlikely(fd < 0))
+        return invalid_shared;
+    struct stat st;
+    if (unlikely(fstat(fd, &st) != 0)) {
+        close(fd);
         return invalid_shared;
     }
-    if (!shared_lock_init(&(region->lock))) {
-        free(region->start);
-        free(region);
+    struct region* region;
+    uint64_t position;
+    if (st.st_size == 0) { // New log
+        region = region_create(size, align, NULL);
+        if (unlikely(!region)) {
+            close(fd);
+            return invalid_shared;
+        }
+        struct log_header header;
+        memcpy(header.magic, log_magic, sizeof(log_magic));
+        header.start = (uint64_t) (uintptr_t) region->start;
+        header.size  = size;
+        header.align = align;
+        if (unlikely(write(fd, &header, sizeof(header)) != (ssize_t) sizeof(header) || fdatasync(fd) != 0)) {
+            tm_destroy(region);
+            close(fd);
+            return invalid_shared;
+        }
+        position = sizeof(header);
+    } else { // Existing log
+        region = log_replay(fd, st.st_size, size, align, &position);
+        if (unlikely(!region)) {
+            close(fd);
+            return invalid_shared;
+        }
+    }
+    region->redo_cap = 4096;
+    region->redo_len = sizeof(struct log_record);
+    region->redo     = (uint8_t*) malloc(region->redo_cap);
+    region->wal      = (struct wal_t*) malloc(sizeof(struct wal_t));
+    if (unlikely(!region->redo || !region->wal || !wal_open(region->wal, fd, position))) {
+        free(region->wal);
+        region->wal = NULL;
+        tm_destroy(region);
+        close(fd);
         return invalid_shared;
     }
-    memset(region->start, 0, size);
-    region->allocs      = NULL;
-    region->size        = size;
-    region->align       = align;
+    region->committed = position;
+    return region;
+}
+
+/** Compare two chunks by address.
+ * @param a First chunk
+ * @param b Second chunk
+ * @return Negative, null or positive as the first chunk starts before, at or after the second one
+**/
+static int checkpoint_compare(void const* a, void const* b) {
+    uint64_t x = ((struct checkpoint_chunk const*) a)->address;
+    uint64_t y = ((struct checkpoint_chunk const*) b)->address;
+    return (x > y) - (x < y);
+}
+
+/** Compute the chunks of the image of a region, i.e. the page ranges covering
+ *  its segments, merged when they share pages, and their place in the file.
+ * @param region  Region to image, with no running read-write transaction
+ * @param nchunks Set to the number of chunks
+ * @return Sorted array of chunks (to free), NULL on failure
+**/
+static struct checkpoint_chunk* checkpoint_chunks(struct region* region, size_t* nchunks) {
+    size_t page   = mapping_page_size();
+    size_t header = segment_header(segment_align(region));
+    size_t count  = 1;
+    for (struct segment_node* sn = region->allocs; sn; sn = sn->next)
+        ++count;
+    struct checkpoint_chunk* chunks = (struct checkpoint_chunk*) malloc(count * sizeof(struct checkpoint_chunk));
+    if (unlikely(!chunks))
+        return NULL;
+    uint64_t first = (uintptr_t) region->start;
+    chunks[0].address = first;
+    chunks[0].length  = region->size;
+    size_t i = 1;
+    for (struct segment_node* sn = region->allocs; sn; sn = sn->next, ++i) {
+        chunks[i].address = (uintptr_t) sn;
+        chunks[i].length  = header + sn->size;
+    }
+    for (i = 0; i < count; ++i) { // Round to whole pages
+        uint64_t end = (chunks[i].address + chunks[i].length + page - 1) & ~((uint64_t) page - 1);
+        chunks[i].address &= ~((uint64_t) page - 1);
+        chunks[i].length   = end - chunks[i].address;
+    }
+    qsort(chunks, count, sizeof(struct checkpoint_chunk), checkpoint_compare);
+    size_t merged = 0;
+    for (i = 1; i < count; ++i) {
+        struct checkpoint_chunk* last = chunks + merged;
+        if (chunks[i].address <= last->address + last->length) {
+            uint64_t end = chunks[i].address + chunks[i].length;
+            if (end > last->address + last->length)
+                last->length = end - last->address;
+        } else {
+            chunks[++merged] = chunks[i];
+        }
+    }
+    *nchunks = merged + 1;
+    uint64_t offset = (sizeof(struct checkpoint_header) + *nchunks * sizeof(struct checkpoint_chunk) + page - 1) & ~((uint64_t) page - 1);
+    for (i = 0; i < *nchunks; ++i) {
+        chunks[i].offset = offset;
+        offset += chunks[i].length;
+    }
+    return chunks;
+}
+
+/** Write a whole buffer at a given offset, retrying on partial writes and interruptions.
+ * @param fd     File to write to
+ * @param data   Buffer to write
+ * @param size   Buffer size (in bytes)
+ * @param offset Offset in the file
+ * @return Whether the operation is a success
+**/
+static bool pwrite_all(int fd, void const* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t res = pwrite(fd, data, size, (off_t) offset);
+        if (unlikely(res < 0)) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data    = (uint8_t const*) data + res;
+        size   -= (size_t) res;
+        offset += (size_t) res;
+    }
+    return true;
+}
+
+/** Write a segment at its place in the image. Only async-signal-safe
+ *  functions are used, as this runs in a forked child.
+ * @param fd      Image file
+ * @param chunks  Sorted chunks of the image
+ * @param nchunks Number of chunks
+ * @param address Address of the segment (or of its node)
+ * @param length  Size of the segment (including its node, in bytes)
+ * @return Whether the operation is a success
+**/
+static bool checkpoint_write(int fd, struct checkpoint_chunk const* chunks, size_t nchunks, uint64_t address, size_t length) {
+    size_t low = 0, high = nchunks; // Find the last chunk starting at or before the address
+    while (high - low > 1) {
+        size_t mid = (low + high) / 2;
+        if (chunks[mid].address <= address)
+            low = mid;
+        else
+            high = mid;
+    }
+    return pwrite_all(fd, (void const*) (uintptr_t) address, length, chunks[low].offset + (address - chunks[low].address));
+}
+
+/** Write a consistent image of a region to a file, from which 'tm_restore'
+ *  can later map it back. Running transactions are not stopped: the image is
+ *  a copy-on-write snapshot taken by forking between two read-write
+ *  transactions, then written by the child process.
+ * @param shared Shared memory region to image
+ * @param path   Path to the image file, atomically replaced on success
+ * @return Whether the image was written
+**/
+bool tm_checkpoint(shared_t shared, char const* path) {
+    struct region* region = (struct region*) shared;
+    size_t pathlen = strlen(path);
+    char* tmppath = (char*) malloc(pathlen + sizeof(".tmp"));
+    if (unlikely(!tmppath))
+        return false;
+    memcpy(tmppath, path, pathlen);
+    memcpy(tmppath + pathlen, ".tmp", sizeof(".tmp"));
+    int fd = open(tmppath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (unlikely(fd < 0)) {
+        free(tmppath);
+        return false;
+    }
+    // A shared access excludes read-write transactions, so the snapshot is
+    // consistent; the writers only wait for the 'fork' itself.
+    struct checkpoint_header header;
+    struct checkpoint_chunk* chunks = NULL;
+    size_t nchunks = 0;
+    pid_t pid = -1;
+    if (likely(shared_lock_acquire_shared(&(region->lock)))) {
+        chunks = checkpoint_chunks(region, &nchunks);
+        if (likely(chunks)) {
+            memcpy(header.magic, checkpoint_magic, sizeof(checkpoint_magic));
+            header.start   = (uintptr_t) region->start;
+            header.size    = region->size;
+            header.align   = region->align;
+            header.allocs  = (uintptr_t) region->allocs;
+            header.nchunks = nchunks;
+            pid = fork();
+        }
+        if (pid == 0) { // Child process: write the image of its copy of the region
+            size_t header_size = segment_header(segment_align(region));
+            bool success = ftruncate(fd, chunks[nchunks - 1].offset + chunks[nchunks - 1].length) == 0
+                && pwrite_all(fd, &header, sizeof(header), 0)
+                && pwrite_all(fd, chunks, nchunks * sizeof(struct checkpoint_chunk), sizeof(header))
+                && checkpoint_write(fd, chunks, nchunks, (uintptr_t) region->start, region->size);
+            for (struct segment_node* sn = region->allocs; success && sn; sn = sn->next)
+                success = checkpoint_write(fd, chunks, nchunks, (uintptr_t) sn, header_size + sn->size);
+            _exit(success && fdatasync(fd) == 0 ? 0 : 1);
+        }
+        shared_lock_release_shared(&(region->lock));
+    }
+    bool success = false;
+    if (pid > 0) {
+        int status;
+        while (waitpid(pid, &status, 0) < 0) {
+            if (errno != EINTR) {
+                status = -1;
+                break;
+            }
+        }
+        success = status >= 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    close(fd);
+    if (likely(success))
+        success = rename(tmppath, path) == 0;
+    else
+        unlink(tmppath);
+    free(chunks);
+    free(tmppath);
+    return success;
+}
+
+/** Restore a region from an image written by 'tm_checkpoint', mapping it at
+ *  the addresses it was taken from. Its pages are read lazily from the file,
+ *  so restoring costs a few system calls whatever the size of the region.
+ *  Memory freed in the restored segments is only reclaimed when the region
+ *  is destroyed.
+ * @param path Path to the image file
+ * @return Opaque shared memory region handle, 'invalid_shared' on failure
+**/
+shared_t tm_restore(char const* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (unlikely(fd < 0))
+        return invalid_shared;
+    struct checkpoint_header header;
+    struct stat st;
+    if (unlikely(fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)
+      || memcmp(header.magic, checkpoint_magic, sizeof(checkpoint_magic)) != 0
+      || header.nchunks == 0 || header.nchunks > (uint64_t) st.st_size / sizeof(struct checkpoint_chunk))) {
+        close(fd);
+        return invalid_shared;
+    }
+    size_t table = header.nchunks * sizeof(struct checkpoint_chunk);
+    struct checkpoint_chunk* chunks = (struct checkpoint_chunk*) malloc(table);
+    struct region* region = region_alloc(header.size, header.align);
+    if (unlikely(!chunks || !region || pread(fd, chunks, table, sizeof(header)) != (ssize_t) table)) {
+        if (region)
+            tm_destroy(region);
+        free(chunks);
+        close(fd);
+        return invalid_shared;
+    }
+    size_t mapped = 0;
+    while (mapped < header.nchunks && mapping_load_at((void*) (uintptr_t) chunks[mapped].address, chunks[mapped].length, fd, chunks[mapped].offset))
+        ++mapped;
+    close(fd); // The mappings keep the file open
+    region->chunks  = chunks;
+    region->nchunks = mapped;
+    if (unlikely(mapped < header.nchunks)) {
+        tm_destroy(region);
+        return invalid_shared;
+    }
+    region->start  = (void*) (uintptr_t) header.start;
+    region->allocs = (segment_list) (uintptr_t) header.allocs;
+    for (struct segment_node* sn = region->allocs; sn; sn = sn->next)
+        sn->mapped = segment_restored;
     return region;
 }
 
@@ -88,12 +751,25 @@ void tm_destroy(shared_t shared) {
     // void*. For this particular implementation, the "real" type of a shared_t
     // is a struct region*.
     struct region* region = (struct region*) shared;
+    if (region->wal) { // Make the pending records durable
+        wal_close(region->wal);
+        free(region->wal);
+    }
+    free(region->redo);
     while (region->allocs) { // Free allocated segments
         segment_list tail = region->allocs->next;
-        free(region->allocs);
+        segment_release(region->allocs);
         region->allocs = tail;
     }
-    free(region->start);
+    if (region->chunks) { // The first segment is part of the image
+        for (size_t i = 0; i < region->nchunks; ++i)
+            mapping_destroy((void*) (uintptr_t) region->chunks[i].address, region->chunks[i].length);
+        free(region->chunks);
+    } else if (region->start_mapped) {
+        mapping_destroy(region->start, region->size);
+    } else {
+        free(region->start);
+    }
     shared_lock_cleanup(&(region->lock));
     free(region);
 }
@@ -122,32 +798,263 @@ size_t tm_align(shared_t shared) {
 }
 
 tx_t tm_begin(shared_t shared, bool is_ro) {
+    struct region* region = (struct region*) shared;
+    // A durable region whose log failed refuses new transactions, as they
+    // could never be made durable.
+    if (unlikely(region->wal && wal_failed(region->wal)))
+        return invalid_tx;
     // We let read-only transactions run in parallel by acquiring a shared
     // access. On the other hand, read-write transactions acquire an exclusive
     // access. At any point in time, the lock can be shared between any number
     // of read-only transactions or held by a single read-write transaction.
+    // A read-only transaction that turns out to modify the region is upgraded
+    // in place rather than restarted (see 'tx_modify').
     if (is_ro) {
         // Note: "unlikely" is a macro that helps branch prediction.
         // It tells the compiler (GCC) that the condition is unlikely to be true
         // and to optimize the code with this additional knowledge.
         // It of course penalizes executions in which the condition turns up to
         // be true.
-        if (unlikely(!shared_lock_acquire_shared(&(((struct region*) shared)->lock))))
+        if (unlikely(!shared_lock_acquire_shared(&(region->lock))))
             return invalid_tx;
-        return read_only_tx;
     } else {
-        if (unlikely(!shared_lock_acquire(&(((struct region*) shared)->lock))))
+        if (unlikely(!shared_lock_acquire(&(region->lock))))
             return invalid_tx;
-        return read_write_tx;
+    }
+    transaction.exclusive = !is_ro;
+    transaction.modified  = false;
+    transaction.aborted   = false;
+    transaction.version   = region->version;
+    transaction.depth     = 0;
+    transaction.undo_len  = 0; // Never inherit the log of a previous transaction
+    return (tx_t) &transaction;
+}
+
+/** [thread-safe] Begin a new transaction, given its expected footprint.
+ *  The hints never change the mode of the transaction, as a wrong hint would
+ *  then make a read-write transaction abort on its upgrade. A read-write
+ *  transaction of a durable region gets its log record sized for its expected
+ *  writes up front. Reads are neither logged nor validated by this engine, so
+ *  scans and small transactions need nothing more.
+ * @param shared Shared memory region to start a transaction on
+ * @param is_ro  Whether the transaction is read-only
+ * @param hints  Expected footprint of the transaction, NULL for none
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+tx_t tm_begin_ext(shared_t shared, bool is_ro, struct tm_hints const* hints) {
+    struct region* region = (struct region*) shared;
+    tx_t tx = tm_begin(shared, is_ro);
+    if (hints && !is_ro && region->wal && likely(tx != invalid_tx))
+        redo_reserve(region, hints->writes * (sizeof(struct log_entry) + region->align)); // Only an optimization: failure is harmless
+    return tx;
+}
+
+/** Prepare a transaction for its modification of the region. A read-only
+ *  transaction is upgraded in place: it trades its shared access for an
+ *  exclusive one, which is only correct if no transaction modified the region
+ *  in between (otherwise what it read may be stale, and it aborts).
+ * @param region Shared memory region associated with the transaction
+ * @param tx     Transaction about to modify the region
+ * @return Whether the transaction can continue (otherwise it has been aborted)
+**/
+static bool tx_modify(struct region* region, struct transaction* tx) {
+    if (unlikely(!tx->exclusive)) {
+        shared_lock_release_shared(&(region->lock));
+        if (unlikely(!shared_lock_acquire(&(region->lock)))) {
+            stats_abort(&(region->stats), stats_abort_write);
+            tx->aborted = true; // The shared access is gone: nothing may be rolled back nor released anymore
+            free(tx->undo);
+            tx->undo     = NULL;
+            tx->undo_len = 0;
+            tx->undo_cap = 0;
+            return false;
+        }
+        if (unlikely(region->version != tx->version)) {
+            shared_lock_release(&(region->lock));
+            stats_abort(&(region->stats), stats_abort_read);
+            tx->aborted = true;
+            free(tx->undo); // Nothing modified yet, so only savepoints to drop
+            tx->undo     = NULL;
+            tx->undo_len = 0;
+            tx->undo_cap = 0;
+            return false;
+        }
+        tx->exclusive = true;
+    }
+    tx->modified = true;
+    return true;
+}
+
+/** Append an entry to the undo log of a transaction.
+ * @param tx      Transaction with at least one open nested scope, or opening one
+ * @param kind    Kind of the entry
+ * @param address Written address (whose current content is saved), or node of the (de)allocated segment
+ * @param size    Written size (in bytes), or size of the redo record for savepoints
+ * @return Whether the entry was appended (false if the log cannot grow)
+**/
+static bool undo_push(struct transaction* tx, uint64_t kind, void* address, size_t size) {
+    size_t length = (kind == undo_write ? size : 0) + sizeof(struct undo_entry);
+    if (unlikely(tx->undo_len + length > tx->undo_cap)) {
+        size_t cap = tx->undo_cap > 0 ? tx->undo_cap : 1024;
+        while (cap < tx->undo_len + length)
+            cap *= 2;
+        uint8_t* undo = (uint8_t*) realloc(tx->undo, cap);
+        if (unlikely(!undo))
+            return false;
+        tx->undo     = undo;
+        tx->undo_cap = cap;
+    }
+    if (kind == undo_write)
+        memcpy(tx->undo + tx->undo_len, address, size);
+    struct undo_entry entry = { kind, address, size };
+    memcpy(tx->undo + tx->undo_len + length - sizeof(entry), &entry, sizeof(entry));
+    tx->undo_len += length;
+    return true;
+}
+
+/** Save what a write is about to overwrite, if a nested scope is open.
+ * @param tx     Transaction about to write
+ * @param target Address about to be written
+ * @param size   Size about to be written (in bytes)
+ * @return Whether the write can proceed (false if the undo log cannot grow)
+**/
+static bool undo_write_prepare(struct transaction* tx, void* target, size_t size) {
+    return likely(tx->depth == 0) || undo_push(tx, undo_write, target, size);
+}
+
+/** Pop the undo log of a transaction down to the savepoint of its innermost
+ *  open scope, restoring everything the scope modified, and close the scope.
+ * @param region Shared memory region associated with the transaction
+ * @param tx     Transaction with at least one open nested scope
+**/
+static void undo_rollback(struct region* region, struct transaction* tx) {
+    while (true) {
+        struct undo_entry entry;
+        tx->undo_len -= sizeof(entry);
+        memcpy(&entry, tx->undo + tx->undo_len, sizeof(entry));
+        if (entry.kind == undo_scope) {
+            if (region->wal) // Drop what the scope appended to the redo record
+                region->redo_len = entry.size;
+            break;
+        }
+        if (entry.kind == undo_write) {
+            tx->undo_len -= entry.size;
+            memcpy(entry.address, tx->undo + tx->undo_len, entry.size);
+        } else if (entry.kind == undo_alloc) {
+            segment_unlink(region, (struct segment_node*) entry.address);
+            segment_release((struct segment_node*) entry.address);
+        } else if (entry.kind == undo_free) {
+            segment_link(region, (struct segment_node*) entry.address);
+        }
+    }
+    --tx->depth;
+}
+
+/** Release the segments freed inside the nested scopes of a transaction, and
+ *  empty its undo log.
+ * @param tx Transaction with no open nested scope left
+**/
+static void undo_settle(struct transaction* tx) {
+    while (tx->undo_len > 0) {
+        struct undo_entry entry;
+        tx->undo_len -= sizeof(entry);
+        memcpy(&entry, tx->undo + tx->undo_len, sizeof(entry));
+        if (entry.kind == undo_write)
+            tx->undo_len -= entry.size;
+        else if (entry.kind == undo_free)
+            segment_release((struct segment_node*) entry.address);
     }
 }
 
 bool tm_end(shared_t shared, tx_t tx) {
-    if (tx == read_only_tx) {
-        shared_lock_release_shared(&(((struct region*) shared)->lock));
+    struct region* region = (struct region*) shared;
+    uint64_t start = stats_now();
+    // In a durable region, a transaction returns only once what it wrote and
+    // what it read is durable. It waits after releasing the lock, so that the
+    // following transactions can append their records meanwhile and share the
+    // same sync.
+    // A transaction that modified nothing commits like a read-only one, even
+    // if it held the lock exclusively: nothing to log, and no version bump.
+    struct transaction* desc = (struct transaction*) tx;
+    if (desc->undo) { // Nested scopes were used: release their freed segments
+        undo_settle(desc);
+        free(desc->undo);
+        desc->undo     = NULL;
+        desc->undo_cap = 0;
+    }
+    uint64_t committed;
+    if (!desc->exclusive) {
+        committed = region->committed;
+        shared_lock_release_shared(&(region->lock));
+    } else if (!desc->modified) {
+        committed = region->committed;
+        shared_lock_release(&(region->lock));
     } else {
-        shared_lock_release(&(((struct region*) shared)->lock));
+        committed = region->wal ? redo_commit(region) : 0;
+        ++region->version;
+        shared_lock_release(&(region->lock));
+    }
+    if (region->wal)
+        wal_wait(region->wal, committed); // On failure, the next 'tm_begin' reports it
+    stats_commit(&(region->stats), start);
+    return true;
+}
+
+/** [thread-safe] Open a (closed) nested scope in a transaction, saving a
+ *  savepoint to which 'tm_rollback_nested' can return.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to nest into
+ * @return Whether the scope was opened (otherwise the transaction goes on, without the scope)
+**/
+bool tm_begin_nested(shared_t shared, tx_t tx) {
+    struct transaction* desc = (struct transaction*) tx;
+    if (unlikely(!undo_push(desc, undo_scope, NULL, ((struct region*) shared)->redo_len)))
+        return false;
+    ++desc->depth;
+    return true;
+}
+
+/** [thread-safe] Close the innermost nested scope of a transaction, merging
+ *  what it did into its parent. Segments freed in the scope are released once
+ *  the outermost scope closes.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction with an open nested scope
+ * @return Whether the transaction can continue
+**/
+bool tm_end_nested(shared_t unused(shared), tx_t tx) {
+    struct transaction* desc = (struct transaction*) tx;
+    if (--desc->depth == 0) {
+        undo_settle(desc);
+        return true;
     }
+    // Turn the savepoint of the scope into a plain entry of its parent
+    size_t offset = desc->undo_len;
+    while (true) {
+        struct undo_entry entry;
+        offset -= sizeof(entry);
+        memcpy(&entry, desc->undo + offset, sizeof(entry));
+        if (entry.kind == undo_scope) {
+            entry.kind = undo_merged;
+            memcpy(desc->undo + offset, &entry, sizeof(entry));
+            return true;
+        }
+        if (entry.kind == undo_write)
+            offset -= entry.size;
+    }
+}
+
+/** [thread-safe] Undo everything the innermost nested scope of a transaction
+ *  did, and close it. To be called when the caller gives up on the scope, or
+ *  when an operation failed inside the scope.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction with an open nested scope
+ * @return Whether the transaction can continue, e.g. to retry the scope (otherwise the whole transaction has been aborted)
+**/
+bool tm_rollback_nested(shared_t shared, tx_t tx) {
+    struct transaction* desc = (struct transaction*) tx;
+    if (unlikely(desc->aborted)) // Failed to upgrade: the lock is already released
+        return false;
+    undo_rollback((struct region*) shared, desc);
     return true;
 }
 
@@ -157,42 +1064,142 @@ bool tm_read(shared_t unused(shared), tx_t unused(tx), void const* source, size_
     return true;
 }
 
-bool tm_write(shared_t unused(shared), tx_t unused(tx), void const* source, size_t size, void* target) {
+bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    if (unlikely(!tx_modify((struct region*) shared, (struct transaction*) tx)))
+        return false;
+    if (unlikely(!undo_write_prepare((struct transaction*) tx, target, size)))
+        return false;
     memcpy(target, source, size);
+    if (((struct region*) shared)->wal)
+        redo_append((struct region*) shared, log_write, target, size, source);
+    return true;
+}
+
+// Note: Batched accesses save one call per access; as this engine neither
+// logs reads nor validates, there is nothing more to amortize.
+bool tm_readv(shared_t unused(shared), tx_t unused(tx), struct tm_access const* accesses, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        memcpy(accesses[i].target, accesses[i].source, accesses[i].size);
     return true;
 }
 
-alloc_t tm_alloc(shared_t shared, tx_t unused(tx), size_t size, void** target) {
+bool tm_writev(shared_t shared, tx_t tx, struct tm_access const* accesses, size_t count) {
+    struct region* region = (struct region*) shared;
+    if (unlikely(!tx_modify(region, (struct transaction*) tx)))
+        return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (unlikely(!undo_write_prepare((struct transaction*) tx, accesses[i].target, accesses[i].size)))
+            return false;
+        memcpy(accesses[i].target, accesses[i].source, accesses[i].size);
+        if (region->wal)
+            redo_append(region, log_write, accesses[i].target, accesses[i].size, accesses[i].source);
+    }
+    return true;
+}
+
+/** [thread-safe] Add a delta to a signed word, unless the result would go below a floor.
+ *  Modifying transactions run alone in this engine, so the delta is applied
+ *  in place; an engine with concurrent writers would keep it aside and apply
+ *  it at commit time, with no read of the word to validate.
+ * @param shared Shared memory region associated with the transaction
+ * @param tx     Transaction to use
+ * @param target Address of the word in the shared region
+ * @param delta  Value to add
+ * @param floor  Lowest value the word may take
+ * @return Whether the delta was applied, or the bound prevented it (the transaction can continue in both cases)
+**/
+add_t tm_add(shared_t shared, tx_t tx, void* target, intptr_t delta, intptr_t floor) {
+    // The bound is checked first, so that a refused delta leaves the
+    // transaction read-only. The word read stays valid across the upgrade,
+    // which aborts if any transaction modified the region in between.
+    intptr_t value;
+    memcpy(&value, target, sizeof(value));
+    if (__builtin_add_overflow(value, delta, &value) || value < floor)
+        return bound_add;
+    if (unlikely(!tx_modify((struct region*) shared, (struct transaction*) tx)))
+        return abort_add;
+    if (unlikely(!undo_write_prepare((struct transaction*) tx, target, sizeof(value))))
+        return abort_add;
+    memcpy(target, &value, sizeof(value));
+    if (((struct region*) shared)->wal)
+        redo_append((struct region*) shared, log_write, target, sizeof(value), &value);
+    return success_add;
+}
+
+alloc_t tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) {
     // We allocate the dynamic segment such that its words are correctly
-    // aligned. Moreover, the alignment of the 'next' and 'prev' pointers must
-    // be satisfied. Thus, we use align on max(align, struct segment_node*).
-    size_t align = ((struct region*) shared)->align;
-    align = align < sizeof(struct segment_node*) ? sizeof(void*) : align;
+    // aligned.
+    struct region* region = (struct region*) shared;
+    if (unlikely(!tx_modify(region, (struct transaction*) tx)))
+        return abort_alloc;
+    size_t align = segment_align(region);
+    size_t header = segment_header(align);
 
+    // Large segments get their own (lazily zero-filled) mapping, the others
+    // come from the heap and are cleared explicitly. In a durable region,
+    // every segment is a mapping so that it can be rebuilt at the same address.
     struct segment_node* sn;
-    if (unlikely(posix_memalign((void**)&sn, align, sizeof(struct segment_node) + size) != 0)) // Allocation failed
-        return nomem_alloc;
+    if ((header + size >= MAPPING_THRESHOLD || region->wal) && align <= mapping_page_size()) {
+        sn = (struct segment_node*) mapping_create(header + size);
+        if (unlikely(!sn)) // Allocation failed
+            return nomem_alloc;
+        sn->mapped = header + size;
+    } else {
+        if (unlikely(posix_memalign((void**)&sn, align, header + size) != 0)) // Allocation failed
+            return nomem_alloc;
+        sn->mapped = 0;
+    }
+    sn->size = size;
 
-    // Insert in the linked list
-    sn->prev = NULL;
-    sn->next = ((struct region*) shared)->allocs;
-    if (sn->next) sn->next->prev = sn;
-    ((struct region*) shared)->allocs = sn;
+    // Insert in the linked list, and inside a nested scope remember to
+    // release the segment should the scope roll back
+    segment_link(region, sn);
+    struct transaction* desc = (struct transaction*) tx;
+    if (desc->depth > 0 && unlikely(!undo_push(desc, undo_alloc, sn, 0))) {
+        segment_unlink(region, sn);
+        segment_release(sn);
+        return nomem_alloc;
+    }
 
-    void* segment = (void*) ((uintptr_t) sn + sizeof(struct segment_node));
-    memset(segment, 0, size);
+    void* segment = (void*) ((uintptr_t) sn + header);
+    if (sn->mapped == 0)
+        memset(segment, 0, size);
+    if (region->wal)
+        redo_append(region, log_alloc, segment, size, NULL);
     *target = segment;
     return success_alloc;
 }
 
-bool tm_free(shared_t shared, tx_t unused(tx), void* segment) {
-    struct segment_node* sn = (struct segment_node*) ((uintptr_t) segment - sizeof(struct segment_node));
+bool tm_free(shared_t shared, tx_t tx, void* segment) {
+    struct region* region = (struct region*) shared;
+    if (unlikely(!tx_modify(region, (struct transaction*) tx)))
+        return false;
+    struct segment_node* sn = (struct segment_node*) ((uintptr_t) segment - segment_header(segment_align(region)));
+
+    // Inside a nested scope, the segment is only released once the outermost
+    // scope closes, as a rollback links it back
+    struct transaction* desc = (struct transaction*) tx;
+    if (desc->depth > 0 && unlikely(!undo_push(desc, undo_free, sn, 0)))
+        return false;
 
     // Remove from the linked list
-    if (sn->prev) sn->prev->next = sn->next;
-    else ((struct region*) shared)->allocs = sn->next;
-    if (sn->next) sn->next->prev = sn->prev;
+    segment_unlink(region, sn);
+
+    if (region->wal)
+        redo_append(region, log_free, segment, 0, NULL);
+    if (desc->depth == 0)
+        segment_release(sn);
+    return true;
+}
 
-    free(sn);
+/** [thread-safe] Get the transaction counters of a region since its creation.
+ *  This engine only aborts read-only transactions failing to upgrade on their
+ *  first modification.
+ * @param shared Shared memory region to query
+ * @param stats  Counters to fill
+ * @return Whether the counters were filled
+**/
+bool tm_stats(shared_t shared, struct tm_stats* stats) {
+    stats_collect(&(((struct region*) shared)->stats), stats);
     return true;
 }
@@ -0,0 +1,165 @@
+// Requested feature: fdatasync
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "macros.h"
+#include "wal.h"
+
+/** Write a whole buffer, retrying on partial writes and interruptions.
+ * @param fd   File to write to
+ * @param data Buffer to write
+ * @param size Buffer size (in bytes)
+ * @return Whether the operation is a success
+**/
+static bool write_all(int fd, uint8_t const* data, size_t size) {
+    while (size > 0) {
+        ssize_t res = write(fd, data, size);
+        if (unlikely(res < 0)) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += res;
+        size -= (size_t) res;
+    }
+    return true;
+}
+
+/** Log thread entry point: repeatedly take every pending record, then write and sync them at once.
+ * @param arg Log to serve
+ * @return NULL
+**/
+static void* wal_run(void* arg) {
+    struct wal_t* wal = (struct wal_t*) arg;
+    uint8_t* spare = NULL; // Buffer handed back to appenders on the next round
+    size_t spare_cap = 0;
+    pthread_mutex_lock(&(wal->mutex));
+    while (true) {
+        while (wal->pending_len == 0 && !wal->closing)
+            pthread_cond_wait(&(wal->work), &(wal->mutex));
+        if (wal->pending_len == 0) // Closing, and nothing left to write
+            break;
+        // Swap the buffers, so that committers keep appending while we sync.
+        uint8_t* batch = wal->pending;
+        size_t batch_len = wal->pending_len;
+        size_t batch_cap = wal->pending_cap;
+        uint64_t batch_end = wal->appended;
+        wal->pending     = spare;
+        wal->pending_len = 0;
+        wal->pending_cap = spare_cap;
+        pthread_mutex_unlock(&(wal->mutex));
+        bool success = !atomic_load(&(wal->failed))
+            && write_all(wal->fd, batch, batch_len)
+            && fdatasync(wal->fd) == 0;
+        pthread_mutex_lock(&(wal->mutex));
+        spare     = batch;
+        spare_cap = batch_cap;
+        if (likely(success))
+            atomic_store(&(wal->durable), batch_end);
+        else
+            atomic_store(&(wal->failed), true);
+        pthread_cond_broadcast(&(wal->synced));
+    }
+    pthread_mutex_unlock(&(wal->mutex));
+    free(spare);
+    return NULL;
+}
+
+bool wal_open(struct wal_t* wal, int fd, uint64_t position) {
+    wal->fd          = fd;
+    wal->pending     = NULL;
+    wal->pending_len = 0;
+    wal->pending_cap = 0;
+    wal->appended    = position;
+    wal->closing     = false;
+    atomic_init(&(wal->durable), position);
+    atomic_init(&(wal->failed), false);
+    if (pthread_mutex_init(&(wal->mutex), NULL) != 0)
+        return false;
+    if (pthread_cond_init(&(wal->work), NULL) != 0) {
+        pthread_mutex_destroy(&(wal->mutex));
+        return false;
+    }
+    if (pthread_cond_init(&(wal->synced), NULL) != 0) {
+        pthread_cond_destroy(&(wal->work));
+        pthread_mutex_destroy(&(wal->mutex));
+        return false;
+    }
+    if (pthread_create(&(wal->thread), NULL, wal_run, wal) != 0) {
+        pthread_cond_destroy(&(wal->synced));
+        pthread_cond_destroy(&(wal->work));
+        pthread_mutex_destroy(&(wal->mutex));
+        return false;
+    }
+    return true;
+}
+
+void wal_close(struct wal_t* wal) {
+    pthread_mutex_lock(&(wal->mutex));
+    wal->closing = true;
+    pthread_cond_signal(&(wal->work));
+    pthread_mutex_unlock(&(wal->mutex));
+    pthread_join(wal->thread, NULL);
+    free(wal->pending);
+    close(wal->fd);
+    pthread_cond_destroy(&(wal->synced));
+    pthread_cond_destroy(&(wal->work));
+    pthread_mutex_destroy(&(wal->mutex));
+}
+
+uint64_t wal_append(struct wal_t* wal, void const* data, size_t size) {
+    pthread_mutex_lock(&(wal->mutex));
+    if (unlikely(atomic_load(&(wal->failed)))) {
+        pthread_mutex_unlock(&(wal->mutex));
+        return 0;
+    }
+    if (wal->pending_len + size > wal->pending_cap) {
+        size_t cap = wal->pending_cap > 0 ? wal->pending_cap : 4096;
+        while (cap < wal->pending_len + size)
+            cap *= 2;
+        uint8_t* pending = (uint8_t*) realloc(wal->pending, cap);
+        if (unlikely(!pending)) {
+            atomic_store(&(wal->failed), true);
+            pthread_cond_broadcast(&(wal->synced));
+            pthread_mutex_unlock(&(wal->mutex));
+            return 0;
+        }
+        wal->pending     = pending;
+        wal->pending_cap = cap;
+    }
+    memcpy(wal->pending + wal->pending_len, data, size);
+    wal->pending_len += size;
+    wal->appended    += size;
+    uint64_t position = wal->appended;
+    pthread_cond_signal(&(wal->work));
+    pthread_mutex_unlock(&(wal->mutex));
+    return position;
+}
+
+bool wal_wait(struct wal_t* wal, uint64_t position) {
+    if (likely(atomic_load(&(wal->durable)) >= position)) // Fast path: already durable
+        return true;
+    pthread_mutex_lock(&(wal->mutex));
+    while (atomic_load(&(wal->durable)) < position && !atomic_load(&(wal->failed)))
+        pthread_cond_wait(&(wal->synced), &(wal->mutex));
+    bool res = atomic_load(&(wal->durable)) >= position;
+    pthread_mutex_unlock(&(wal->mutex));
+    return res;
+}
+
+void wal_fail(struct wal_t* wal) {
+    pthread_mutex_lock(&(wal->mutex));
+    atomic_store(&(wal->failed), true);
+    pthread_cond_broadcast(&(wal->synced));
+    pthread_mutex_unlock(&(wal->mutex));
+}
+
+bool wal_failed(struct wal_t* wal) {
+    return atomic_load_explicit(&(wal->failed), memory_order_relaxed);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Append-only write-ahead log file, written and synced by a dedicated
+ * thread. Every record appended while the thread is busy syncing is written
+ * and synced by its next round, so concurrent committers share one sync
+ * (group commit). Positions are byte offsets in the log file.
+ */
+struct wal_t {
+    int fd;                  // Log file, positioned at its end
+    pthread_t thread;        // Log thread
+    pthread_mutex_t mutex;   // Protects the pending buffer and the appended position
+    pthread_cond_t work;     // Signaled when records are appended, or when closing
+    pthread_cond_t synced;   // Broadcast when the durable position advances, or on failure
+    uint8_t* pending;        // Records appended but not yet taken by the log thread
+    size_t pending_len;      // Used size of the pending buffer (in bytes)
+    size_t pending_cap;      // Capacity of the pending buffer (in bytes)
+    uint64_t appended;       // Position after the last appended record
+    _Atomic(uint64_t) durable; // Position up to which the records are durable
+    atomic_bool failed;      // Whether a record could not be buffered, written or synced
+    bool closing;            // Whether the log thread must drain the pending records and terminate
+};
+
+/** Start the log thread on the given file.
+ * @param wal      Log to initialize
+ * @param fd       Log file, positioned at the end of its valid content (ownership is transferred on success)
+ * @param position Current end of the valid content of the file
+ * @return Whether the operation is a success
+**/
+bool wal_open(struct wal_t* wal, int fd, uint64_t position);
+
+/** Write and sync the pending records, stop the log thread and close the file.
+ * @param wal Log to close
+**/
+void wal_close(struct wal_t* wal);
+
+/** [thread-safe] Append a record, without waiting for it to be durable.
+ * @param wal  Log to append to
+ * @param data Record content
+ * @param size Record size (in bytes)
+ * @return Position to wait for for the record to be durable, 0 on failure
+**/
+uint64_t wal_append(struct wal_t* wal, void const* data, size_t size);
+
+/** [thread-safe] Wait until every record up to the given position is durable.
+ * @param wal      Log to wait on
+ * @param position Position to wait for
+ * @return Whether the records are durable (false if the log failed)
+**/
+bool wal_wait(struct wal_t* wal, uint64_t position);
+
+/** [thread-safe] Mark the log as failed, e.g. when a record could not be built.
+ * @param wal Log to mark
+**/
+void wal_fail(struct wal_t* wal);
+
+/** [thread-safe] Check whether the log failed, in which case nothing appended
+ *  from then on will ever become durable.
+ * @param wal Log to check
+ * @return Whether the log failed
+**/
+bool wal_failed(struct wal_t* wal);